@@ -0,0 +1,356 @@
+#include "boardStorage.hpp"
+#include "circuitGenerators.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <optional>
+#include <print>
+#include <random>
+#include <ranges>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Times the BoardStorage operations the editor runs on every click, drag and load, on generated boards
+// The results are printed as JSON, latencies are in microseconds
+
+static constexpr std::string_view usage = R"(Usage: CircuitSimulatorBoardBenchmark [options]
+Options:
+  --sizes <n,n,...>           Element counts of the generated boards (default 1000,10000,100000,1000000)
+  --samples <n>               Queries and removals timed on every board (default 10000)
+  --output <path>             Write the JSON to a file instead of stdout
+)";
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+	std::vector<uint32_t> sizes{1'000, 10'000, 100'000, 1'000'000};
+	uint32_t samples = 10'000;
+	std::filesystem::path output{};
+};
+
+struct Operation {
+	std::string_view name;
+	// Microseconds per call
+	std::vector<double> latencies{};
+	// Tiles added to or removed from the tile maps, 0 for the queries
+	uint64_t tiles = 0;
+};
+
+struct BoardResult {
+	uint32_t elements;
+	size_t lines = 0;
+	size_t elementTiles = 0;
+	size_t lineSegments = 0;
+	size_t connections = 0;
+	size_t footprint = 0;
+	std::vector<Operation> operations{};
+};
+
+static double microseconds(Clock::duration duration) {
+	return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+static void timed(Operation &operation, auto &&func) {
+	const auto start = Clock::now();
+	func();
+	operation.latencies.emplace_back(microseconds(Clock::now() - start));
+}
+
+// Heap used by the board, every entry of a node based container is counted as its own allocation
+static size_t footprint(const BoardStorage &board) {
+	const auto elementsSize = [](const std::vector<ElementData> &elements) {
+		size_t ret = elements.capacity() * sizeof(ElementData);
+		for (const auto &data: elements) {
+			ret += data.element.nodes.capacity() * sizeof(Coords);
+			ret += data.element.propertiesValues.capacity() * sizeof(PropertyVariant);
+		}
+		return ret;
+	};
+	const auto mapSize = [](const auto &map, auto &&valueSize) {
+		using Entry = typename std::remove_cvref_t<decltype(map)>::value_type;
+		// Next pointer and cached hash of every node
+		size_t ret = map.bucket_count() * sizeof(void *) + map.size() * (sizeof(Entry) + sizeof(void *) + sizeof(size_t));
+		for (const auto &[_, value]: map) ret += valueSize(value);
+		return ret;
+	};
+	const auto tilesSize = [](const std::vector<ElementId> &ids) {
+		return ids.capacity() * sizeof(ElementId);
+	};
+	const auto segmentsSize = [](const SegmentIndex::Track &track) {
+		return track.segments.capacity() * sizeof(SegmentIndex::Segment) + track.reach.capacity() * sizeof(int32_t);
+	};
+
+	return elementsSize(board.elements) + elementsSize(board.lines) +
+		   mapSize(board.elementTiles, tilesSize) +
+		   mapSize(board.lineSegments.rows, segmentsSize) + mapSize(board.lineSegments.columns, segmentsSize) +
+		   mapSize(board.connections, [](const ConnectionNode &node) {
+			   return node.connections.capacity() * sizeof(Connection);
+		   });
+}
+
+static std::optional<uint32_t> parseCount(std::string_view value) {
+	uint32_t ret = 0;
+	const auto [ptr, error] = std::from_chars(value.data(), value.data() + value.size(), ret);
+	if (error != std::errc{} || ptr != value.data() + value.size() || ret == 0) return std::nullopt;
+	return ret;
+}
+
+static std::optional<Options> parseArguments(std::span<char *> args) {
+	Options ret{};
+	for (size_t i = 0; i < args.size(); i++) {
+		const std::string_view arg{args[i]};
+		const auto next = [&]() -> std::optional<std::string_view> {
+			if (i + 1 >= args.size()) {
+				std::println(stderr, "Missing value for {}", arg);
+				return std::nullopt;
+			}
+			return args[++i];
+		};
+
+		if (arg == "--sizes") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			ret.sizes.clear();
+			for (const auto &part: *value | std::views::split(',')) {
+				const std::string_view str{part.begin(), part.end()};
+				const auto size = parseCount(str);
+				if (!size) {
+					std::println(stderr, "Invalid size: {}", str);
+					return std::nullopt;
+				}
+				ret.sizes.emplace_back(*size);
+			}
+		} else if (arg == "--samples") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			const auto samples = parseCount(*value);
+			if (!samples) {
+				std::println(stderr, "Invalid samples: {}", *value);
+				return std::nullopt;
+			}
+			ret.samples = *samples;
+		} else if (arg == "--output") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			ret.output = *value;
+		} else {
+			std::println(stderr, "Unknown option: {}", arg);
+			return std::nullopt;
+		}
+	}
+	return ret;
+}
+
+static BoardResult run(uint32_t elementCount, const Options &options) {
+	using CircuitGenerators::Placer;
+	BoardResult ret{.elements = elementCount};
+	// Fixed seed so every run and every version does the same queries
+	std::mt19937 generator{1234};
+
+	// Vertical resistors in rows, with a wire running along the whole board under every row
+	const auto columns = static_cast<int32_t>(std::ceil(std::sqrt(static_cast<double>(elementCount))));
+	const auto rows = static_cast<int32_t>((elementCount + columns - 1) / columns);
+	const Coords boardSize{columns * Placer::step, rows * 2 * Placer::step};
+
+	BoardStorage board{};
+	const Placer placer{board};
+	Operation placeElement{.name = "placeElement"};
+	for (uint32_t i = 0; i < elementCount; i++) {
+		const auto column = static_cast<int32_t>(i) % columns;
+		const auto row = static_cast<int32_t>(i) / columns;
+		timed(placeElement, [&] {
+			// Resistor
+			placer.twoTerminal(4, Placer::point(column, row * 2), Placer::point(column, row * 2 + 1), 1000.f);
+		});
+		placeElement.tiles += static_cast<uint64_t>(board.elements.back().element.size.x * board.elements.back().element.size.y);
+	}
+	Operation placeLine{.name = "placeLine"};
+	for (int32_t row = 0; row < rows; row++) {
+		const auto y = row * 2 * Placer::step + Placer::step + Placer::step / 2;
+		timed(placeLine, [&] {
+			placer.line(Coords{0, y}, Coords{boardSize.x, y});
+		});
+		placeLine.tiles += static_cast<uint64_t>(boardSize.x);
+	}
+
+	ret.lines = board.lines.size();
+	ret.elementTiles = board.elementTiles.size();
+	ret.lineSegments = board.lineSegments.size();
+	ret.connections = board.connections.size();
+	ret.footprint = footprint(board);
+
+	std::uniform_int_distribution<int32_t> randomX{0, boardSize.x - 1};
+	std::uniform_int_distribution<int32_t> randomY{0, boardSize.y - 1};
+	const auto randomCoords = [&]() {
+		return Coords{randomX(generator), randomY(generator)};
+	};
+
+	Operation overlapping{.name = "isElementOverlapping"};
+	const auto &probe = board.elements.front().element;
+	for (uint32_t i = 0; i < options.samples; i++) {
+		Element moved{.id = probe.id, .size = probe.size, .pos = randomCoords(), .component = probe.component};
+		timed(overlapping, [&] {
+			[[maybe_unused]] volatile bool result = board.isElementOverlapping(moved);
+		});
+	}
+
+	// Same lookup as a right click in the editor
+	Operation closest{.name = "getClosestElementData"};
+	for (uint32_t i = 0; i < options.samples; i++) {
+		const auto coords = randomCoords();
+		timed(closest, [&] {
+			if (auto it = board.elementTiles.find(coords); it != board.elementTiles.end()) {
+				[[maybe_unused]] volatile bool found = board.getClosestElementData(it->second, coords).has_value();
+			}
+		});
+	}
+
+	// About a full screen worth of tiles
+	constexpr Coords selectionSize{96, 54};
+	Operation selectBox{.name = "selectBox"};
+	for (uint32_t i = 0; i < options.samples; i++) {
+		const auto start = randomCoords();
+		timed(selectBox, [&] {
+			[[maybe_unused]] volatile size_t count = board.selectBox(start, start + selectionSize).elements.size();
+		});
+	}
+
+	const auto path = std::filesystem::temp_directory_path() / "CircuitSimulatorBoardBenchmark.sqcs";
+	Operation save{.name = "saveToFile"};
+	Operation load{.name = "loadFromFile"};
+	for (uint32_t i = 0; i < 3; i++) {
+		timed(save, [&] {
+			board.saveToFile(path);
+		});
+		BoardStorage loaded{};
+		timed(load, [&] {
+			loaded.loadFromFile(path);
+		});
+		load.tiles += loaded.elementTiles.size() + loaded.lineSegments.size();
+	}
+	std::filesystem::remove(path);
+
+	// Same rebuild a load runs, once on the calling thread and once with the shared pool
+	Operation rebuildNets{.name = "rebuildNets"};
+	Operation parallelRebuildNets{.name = "parallelRebuildNets"};
+	for (uint32_t i = 0; i < 3; i++) {
+		timed(rebuildNets, [&] {
+			board.nets.rebuild(board);
+		});
+		timed(parallelRebuildNets, [&] {
+			board.nets.rebuild(board, &ThreadPool::shared());
+		});
+	}
+
+	// Removals last, in a random order
+	const auto removeSample = [&](Operation &operation, const std::vector<ElementData> &storage, auto &&remove) {
+		std::vector<ElementId> ids{};
+		ids.reserve(storage.size());
+		for (const auto &data: storage) ids.emplace_back(data.element.id);
+		std::ranges::shuffle(ids, generator);
+		ids.resize(std::min<size_t>(ids.size(), options.samples));
+		for (const auto &id: ids) {
+			const auto size = std::invoke([&]() {
+				const auto &element = (*BoardStorage::lower_bound(storage, id)).element;
+				return static_cast<uint64_t>(element.size.x * element.size.y);
+			});
+			timed(operation, [&] {
+				remove(id);
+			});
+			operation.tiles += size;
+		}
+	};
+	Operation removeElement{.name = "removeElement"};
+	removeSample(removeElement, board.elements, [&](ElementId id) {
+		board.removeElement(id);
+	});
+	Operation removeLine{.name = "removeLine"};
+	removeSample(removeLine, board.lines, [&](ElementId id) {
+		board.removeLine(id);
+	});
+
+	ret.operations = {placeElement, placeLine, overlapping, closest, selectBox, save, load, rebuildNets, parallelRebuildNets, removeElement, removeLine};
+	return ret;
+}
+
+static std::string latencies(const Operation &operation) {
+	auto values = operation.latencies;
+	if (values.empty()) return "null";
+	std::ranges::sort(values);
+	const auto percentile = [&](double p) {
+		return values.at(std::min(values.size() - 1, static_cast<size_t>(p * static_cast<double>(values.size()))));
+	};
+	double total = 0.0;
+	for (const auto &value: values) total += value;
+
+	auto ret = std::format(
+		"{{\"count\": {}, \"mean\": {}, \"p50\": {}, \"p90\": {}, \"p99\": {}, \"max\": {}",
+		values.size(),
+		total / static_cast<double>(values.size()),
+		percentile(0.5),
+		percentile(0.9),
+		percentile(0.99),
+		values.back()
+	);
+	if (operation.tiles > 0 && total > 0.0) {
+		ret += std::format(", \"tilesPerSecond\": {}", static_cast<double>(operation.tiles) / total * 1e6);
+	}
+	return ret + "}";
+}
+
+static void write(std::FILE *out, const std::vector<BoardResult> &results, const Options &options) {
+	std::println(out, "{{");
+	std::println(out, "  \"unit\": \"us\",");
+	std::println(out, "  \"samples\": {},", options.samples);
+	std::println(out, "  \"results\": [");
+	for (const auto &[index, result]: results | std::views::enumerate) {
+		std::println(out, "    {{");
+		std::println(out, "      \"elements\": {},", result.elements);
+		std::println(out, "      \"lines\": {},", result.lines);
+		std::println(out, "      \"elementTiles\": {},", result.elementTiles);
+		std::println(out, "      \"lineSegments\": {},", result.lineSegments);
+		std::println(out, "      \"connections\": {},", result.connections);
+		std::println(out, "      \"footprintBytes\": {},", result.footprint);
+		std::println(out, "      \"operations\": {{");
+		for (const auto &[operationIndex, operation]: result.operations | std::views::enumerate) {
+			std::println(out, "        \"{}\": {}{}", operation.name, latencies(operation), static_cast<size_t>(operationIndex) + 1 == result.operations.size() ? "" : ",");
+		}
+		std::println(out, "      }}");
+		std::println(out, "    }}{}", static_cast<size_t>(index) + 1 == results.size() ? "" : ",");
+	}
+	std::println(out, "  ]");
+	std::println(out, "}}");
+}
+
+int main(int argc, char **argv) {
+	const auto options = parseArguments(std::span(argv, static_cast<size_t>(argc)).subspan(1));
+	if (!options) {
+		std::print(stderr, "{}", usage);
+		return 1;
+	}
+
+	std::vector<BoardResult> results{};
+	for (const auto &size: options->sizes) {
+		std::println(stderr, "Board with {} elements", size);
+		results.emplace_back(run(size, *options));
+	}
+
+	if (options->output.empty()) {
+		write(stdout, results, *options);
+	} else {
+		std::FILE *out = std::fopen(options->output.string().c_str(), "w");
+		if (!out) {
+			std::println(stderr, "Failed to open {}", options->output.string());
+			return 1;
+		}
+		write(out, results, *options);
+		std::fclose(out);
+	}
+
+	return 0;
+}
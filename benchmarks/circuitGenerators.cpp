@@ -0,0 +1,173 @@
+#include "circuitGenerators.hpp"
+#include "components/componentStore.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+void CircuitGenerators::Placer::twoTerminal(uint32_t componentId, const Coords &a, const Coords &b, float value) const {
+	const auto &component = ComponentStore::components.at(componentId).get();
+	for (uint32_t rotation = 0; rotation < 4; rotation++) {
+		auto nodes = Utils::rotateNodes(rotation, component);
+		if (!(nodes.at(1) - nodes.at(0) == b - a)) continue;
+
+		auto properties = getProperties(0, component);
+		if (!properties.empty()) std::get<NumberProperty>(properties.front()).value = value;
+		const auto pos = a - nodes.at(0);
+		board.placeElement(Element{
+			.size{Utils::componentSizeWithRotation(component, rotation)},
+			.pos{pos},
+			.rotation = rotation,
+			.nodes{std::move(nodes)},
+			.component = component,
+			.propertiesValues = std::move(properties),
+		});
+		return;
+	}
+}
+
+void CircuitGenerators::Placer::ground(const Coords &at) const {
+	// Ground
+	const auto &component = ComponentStore::components.at(5).get();
+	board.placeElement(Element{
+		.size{Utils::componentSizeWithRotation(component, 0)},
+		.pos{at - component.nodes.at(0)},
+		.nodes{component.nodes},
+		.component = component,
+	});
+}
+
+void CircuitGenerators::Placer::line(const Coords &a, const Coords &b) const {
+	// Same layout as the lines read from a save file
+	const auto endOffset = (a - b).abs();
+	Coords size = endOffset;
+	if (size.x == 0)
+		size.x++;
+	else
+		size.y++;
+
+	board.placeLine(Element{
+		.size{size},
+		.pos{Coords::min(a, b)},
+		.nodes{{0, 0}, endOffset},
+		// Conductor
+		.component = ComponentStore::components.at(0),
+	});
+}
+
+// Voltage source on the left of the top row, its negative side is the start of the ground rail
+static void ladder(BoardStorage &board, uint32_t stages, auto &&shunt) {
+	using CircuitGenerators::Placer;
+	const Placer placer{board};
+
+	// Voltage source
+	placer.twoTerminal(2, Placer::point(0, 1), Placer::point(0, 0), 10.f);
+	placer.ground(Placer::point(0, 1));
+	placer.line(Placer::point(0, 1), Placer::point(static_cast<int32_t>(stages), 1));
+	for (int32_t i = 1; i <= static_cast<int32_t>(stages); i++) {
+		// Resistor
+		placer.twoTerminal(4, Placer::point(i - 1, 0), Placer::point(i, 0), 1000.f);
+		shunt(placer, Placer::point(i, 0), Placer::point(i, 1));
+	}
+}
+
+void CircuitGenerators::resistorMesh(BoardStorage &board, uint32_t elementCount) {
+	const Placer placer{board};
+	const auto side = std::max(2, static_cast<int32_t>(std::sqrt(static_cast<double>(elementCount) / 2.0)));
+
+	// Voltage source
+	placer.twoTerminal(2, Placer::point(-1, 1), Placer::point(-1, 0), 10.f);
+	placer.ground(Placer::point(-1, 1));
+	placer.line(Placer::point(-1, 0), Placer::point(0, 0));
+	for (int32_t x = 0; x < side; x++) {
+		for (int32_t y = 0; y < side; y++) {
+			// Resistors
+			if (x + 1 < side) placer.twoTerminal(4, Placer::point(x, y), Placer::point(x + 1, y), 1000.f);
+			if (y + 1 < side) placer.twoTerminal(4, Placer::point(x, y), Placer::point(x, y + 1), 1000.f);
+		}
+	}
+	placer.ground(Placer::point(side - 1, side - 1));
+}
+
+void CircuitGenerators::r2rLadder(BoardStorage &board, uint32_t elementCount) {
+	ladder(board, std::max(1u, elementCount / 2), [](const Placer &placer, const Coords &top, const Coords &bottom) {
+		// Resistor
+		placer.twoTerminal(4, top, bottom, 2000.f);
+	});
+}
+
+void CircuitGenerators::rcLadder(BoardStorage &board, uint32_t elementCount) {
+	ladder(board, std::max(1u, elementCount / 2), [](const Placer &placer, const Coords &top, const Coords &bottom) {
+		// Capacitor
+		placer.twoTerminal(6, top, bottom, 1e-6f);
+	});
+}
+
+void CircuitGenerators::manySources(BoardStorage &board, uint32_t elementCount) {
+	ladder(board, std::max(1u, elementCount / 2), [](const Placer &placer, const Coords &top, const Coords &bottom) {
+		// Voltage source
+		placer.twoTerminal(2, bottom, top, 5.f);
+	});
+}
+
+void CircuitGenerators::groundStubLadder(BoardStorage &board, uint32_t elementCount) {
+	const Placer placer{board};
+	// A series resistor, a shunt resistor and a ground per stage
+	const auto stages = static_cast<int32_t>(std::max(1u, elementCount / 3));
+
+	// Voltage source
+	placer.twoTerminal(2, Placer::point(0, 1), Placer::point(0, 0), 10.f);
+	placer.ground(Placer::point(0, 1));
+	for (int32_t i = 1; i <= stages; i++) {
+		// Resistors
+		placer.twoTerminal(4, Placer::point(i - 1, 0), Placer::point(i, 0), 1000.f);
+		placer.twoTerminal(4, Placer::point(i, 0), Placer::point(i, 1), 2000.f);
+		placer.ground(Placer::point(i, 1));
+	}
+}
+
+void CircuitGenerators::randomSparse(BoardStorage &board, uint32_t elementCount) {
+	const Placer placer{board};
+	// The rows and the links between them have about side² edges and the random ones add another quarter
+	const auto side = std::max(2, static_cast<int32_t>(std::sqrt(static_cast<double>(elementCount) / 1.25)));
+	// Fixed seed so every run and every version gets the same circuit
+	std::mt19937 generator{1234};
+	std::uniform_real_distribution<float> resistance{100.f, 10000.f};
+	std::uniform_real_distribution<float> chance{0.f, 1.f};
+
+	const auto edge = [&](const Coords &a, const Coords &b) {
+		if (chance(generator) < 0.1f) {
+			// Capacitor
+			placer.twoTerminal(6, a, b, 1e-6f);
+		} else {
+			// Resistor
+			placer.twoTerminal(4, a, b, resistance(generator));
+		}
+	};
+
+	// Voltage source
+	placer.twoTerminal(2, Placer::point(-1, 1), Placer::point(-1, 0), 10.f);
+	placer.ground(Placer::point(-1, 1));
+	placer.line(Placer::point(-1, 0), Placer::point(0, 0));
+	for (int32_t y = 0; y < side; y++) {
+		// Every row is connected end to end and linked to the next one at alternating ends, so no point is left floating
+		for (int32_t x = 0; x + 1 < side; x++) {
+			edge(Placer::point(x, y), Placer::point(x + 1, y));
+		}
+		if (y + 1 >= side) continue;
+		const auto pathColumn = y % 2 == 0 ? side - 1 : 0;
+		for (int32_t x = 0; x < side; x++) {
+			if (x == pathColumn || chance(generator) < 0.25f) edge(Placer::point(x, y), Placer::point(x, y + 1));
+		}
+	}
+	placer.ground(Placer::point(side - 1, side - 1));
+}
+
+const std::vector<CircuitGenerators::Generator> CircuitGenerators::generators{
+	Generator{.name = "resistorMesh", .build = resistorMesh},
+	Generator{.name = "r2rLadder", .build = r2rLadder},
+	Generator{.name = "rcLadder", .build = rcLadder},
+	Generator{.name = "randomSparse", .build = randomSparse},
+	Generator{.name = "manySources", .build = manySources},
+	Generator{.name = "groundStubLadder", .build = groundStubLadder},
+};
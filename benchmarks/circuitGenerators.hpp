@@ -0,0 +1,49 @@
+#pragma once
+
+#include "boardStorage.hpp"
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+// Builds boards of parametric circuits for the benchmarks
+// Every generator aims for roughly the requested number of elements
+namespace CircuitGenerators {
+	// Places components so that their nodes land on the given grid points
+	struct Placer {
+		BoardStorage &board;
+
+		// Two terminal components span this many tiles, neighbouring grid points are this far apart
+		static constexpr int32_t step = 4;
+
+		// a and b have to be one step apart horizontally or vertically
+		void twoTerminal(uint32_t componentId, const Coords &a, const Coords &b, float value) const;
+		void ground(const Coords &at) const;
+		// a and b have to be on the same row or column
+		void line(const Coords &a, const Coords &b) const;
+
+		[[nodiscard]] static Coords point(int32_t x, int32_t y) {
+			return {x * step, y * step};
+		}
+	};
+
+	struct Generator {
+		std::string_view name;
+		std::function<void(BoardStorage &, uint32_t elementCount)> build;
+	};
+
+	// Square mesh of resistors fed by a voltage source at one corner and grounded at the opposite one
+	void resistorMesh(BoardStorage &board, uint32_t elementCount);
+	// R-2R ladder, series resistors along the top and twice as large ones down to the ground rail
+	void r2rLadder(BoardStorage &board, uint32_t elementCount);
+	// Series resistors along the top and capacitors down to the ground rail
+	void rcLadder(BoardStorage &board, uint32_t elementCount);
+	// Square lattice with every row connected and random vertical edges, mostly resistors with some capacitors
+	void randomSparse(BoardStorage &board, uint32_t elementCount);
+	// Series resistors along the top and a voltage source down to the ground rail at every node
+	void manySources(BoardStorage &board, uint32_t elementCount);
+	// R-2R ladder where every stage has a ground of its own instead of a rail
+	void groundStubLadder(BoardStorage &board, uint32_t elementCount);
+
+	extern const std::vector<Generator> generators;
+}// namespace CircuitGenerators
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include "acSimulation.hpp"
+#include "circuitGenerators.hpp"
+#include "dcSimulation.hpp"
+#include "graphDescriptor.hpp"
+#include "resultCache.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <print>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Times the extraction, the result cache key and every stage of the D.C. and A.C. simulations on generated circuits
+// The results are printed as JSON so runs of different versions can be compared
+
+static constexpr std::string_view usage = R"(Usage: CircuitSimulatorSolverBenchmark [options]
+Options:
+  --sizes <n,n,...>           Target element counts (default 10,100,1000,10000,100000,1000000)
+  --generators <name,...>     Circuits to generate (default all of them)
+  --repetitions <n>           Runs of every case, the median and the minimum are reported (default 3)
+  --frequency <Hz>            Frequency of the A.C. analysis (default 50)
+  --output <path>             Write the JSON to a file instead of stdout
+)";
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+	std::vector<uint32_t> sizes{10, 100, 1'000, 10'000, 100'000, 1'000'000};
+	std::vector<std::string_view> generators{};
+	uint32_t repetitions = 3;
+	float frequency = 50.f;
+	std::filesystem::path output{};
+};
+
+// Milliseconds spent in every stage over the repetitions of one case
+struct StageTimes {
+	std::map<SimulationProgress::Stage, std::vector<double>> stages{};
+	std::vector<double> total{};
+};
+
+struct CaseResult {
+	std::string_view generator;
+	uint32_t targetElements;
+	size_t elements = 0;
+	size_t nodes = 0;
+	std::vector<double> extraction{};
+	// Same extraction with the shared thread pool
+	std::vector<double> parallelExtraction{};
+	// Canonical netlist the result cache builds on every run, the ladders are its worst case
+	std::vector<double> canonicalization{};
+	StageTimes dc{};
+	StageTimes ac{};
+	bool dcSolved = true;
+	bool acSolved = true;
+};
+
+static double milliseconds(Clock::duration duration) {
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Runs a simulation with a progress whose stage hook adds the time since the previous stage to that stage
+template<class T>
+static bool timeStages(StageTimes &times, auto &&run) {
+	std::map<SimulationProgress::Stage, double> elapsed{};
+	auto current = SimulationProgress::Stage::extraction;
+	auto stageStart = Clock::now();
+
+	SimulationProgress progress{};
+	progress.onStage = [&](SimulationProgress::Stage stage) {
+		const auto now = Clock::now();
+		elapsed[current] += milliseconds(now - stageStart);
+		current = stage;
+		stageStart = now;
+	};
+
+	const auto start = Clock::now();
+	const T simulation = run(progress);
+	const auto end = Clock::now();
+	elapsed[current] += milliseconds(end - stageStart);
+
+	for (const auto &[stage, value]: elapsed) {
+		if (stage == SimulationProgress::Stage::extraction) continue;
+		times.stages[stage].emplace_back(value);
+	}
+	times.total.emplace_back(milliseconds(end - start));
+	return !simulation.voltages.empty();
+}
+
+static std::optional<std::vector<std::string_view>> split(std::string_view list) {
+	std::vector<std::string_view> ret{};
+	for (const auto &part: list | std::views::split(',')) {
+		ret.emplace_back(part.begin(), part.end());
+	}
+	if (std::ranges::any_of(ret, &std::string_view::empty)) return std::nullopt;
+	return ret;
+}
+
+static std::optional<uint32_t> parseCount(std::string_view value) {
+	uint32_t ret = 0;
+	const auto [ptr, error] = std::from_chars(value.data(), value.data() + value.size(), ret);
+	if (error != std::errc{} || ptr != value.data() + value.size() || ret == 0) return std::nullopt;
+	return ret;
+}
+
+static std::optional<Options> parseArguments(std::span<char *> args) {
+	Options ret{};
+	for (size_t i = 0; i < args.size(); i++) {
+		const std::string_view arg{args[i]};
+		const auto next = [&]() -> std::optional<std::string_view> {
+			if (i + 1 >= args.size()) {
+				std::println(stderr, "Missing value for {}", arg);
+				return std::nullopt;
+			}
+			return args[++i];
+		};
+
+		if (arg == "--sizes") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			const auto parts = split(*value);
+			if (!parts) {
+				std::println(stderr, "Invalid sizes: {}", *value);
+				return std::nullopt;
+			}
+			ret.sizes.clear();
+			for (const auto &part: *parts) {
+				const auto size = parseCount(part);
+				if (!size) {
+					std::println(stderr, "Invalid size: {}", part);
+					return std::nullopt;
+				}
+				ret.sizes.emplace_back(*size);
+			}
+		} else if (arg == "--generators") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			const auto parts = split(*value);
+			if (!parts) {
+				std::println(stderr, "Invalid generators: {}", *value);
+				return std::nullopt;
+			}
+			ret.generators = *parts;
+		} else if (arg == "--repetitions") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			const auto repetitions = parseCount(*value);
+			if (!repetitions) {
+				std::println(stderr, "Invalid repetitions: {}", *value);
+				return std::nullopt;
+			}
+			ret.repetitions = *repetitions;
+		} else if (arg == "--frequency") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			const auto [_, error] = std::from_chars(value->data(), value->data() + value->size(), ret.frequency);
+			if (error != std::errc{}) {
+				std::println(stderr, "Invalid frequency: {}", *value);
+				return std::nullopt;
+			}
+		} else if (arg == "--output") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			ret.output = *value;
+		} else {
+			std::println(stderr, "Unknown option: {}", arg);
+			return std::nullopt;
+		}
+	}
+	return ret;
+}
+
+static std::string_view stageName(SimulationProgress::Stage stage) {
+	switch (stage) {
+		case SimulationProgress::Stage::extraction:
+			return "extraction";
+		case SimulationProgress::Stage::assembly:
+			return "assembly";
+		case SimulationProgress::Stage::factorization:
+			return "factorization";
+		case SimulationProgress::Stage::solve:
+			return "solve";
+		case SimulationProgress::Stage::done:
+			return "done";
+	}
+	return "";
+}
+
+static std::string statistics(std::vector<double> values) {
+	if (values.empty()) return "null";
+	std::ranges::sort(values);
+	return std::format("{{\"median\": {}, \"min\": {}}}", values.at(values.size() / 2), values.front());
+}
+
+static std::string stageTimes(const StageTimes &times) {
+	std::string ret{"{"};
+	for (const auto &[stage, values]: times.stages) {
+		ret += std::format("\"{}\": {}, ", stageName(stage), statistics(values));
+	}
+	return ret + std::format("\"total\": {}}}", statistics(times.total));
+}
+
+static void write(std::FILE *out, const std::vector<CaseResult> &results, const Options &options) {
+	std::println(out, "{{");
+	std::println(out, "  \"unit\": \"ms\",");
+	std::println(out, "  \"repetitions\": {},", options.repetitions);
+	std::println(out, "  \"frequency\": {},", options.frequency);
+	std::println(out, "  \"results\": [");
+	for (const auto &[index, result]: results | std::views::enumerate) {
+		std::println(out, "    {{");
+		std::println(out, "      \"generator\": \"{}\",", result.generator);
+		std::println(out, "      \"targetElements\": {},", result.targetElements);
+		std::println(out, "      \"elements\": {},", result.elements);
+		std::println(out, "      \"nodes\": {},", result.nodes);
+		std::println(out, "      \"extraction\": {},", statistics(result.extraction));
+		std::println(out, "      \"parallelExtraction\": {},", statistics(result.parallelExtraction));
+		std::println(out, "      \"canonicalization\": {},", statistics(result.canonicalization));
+		std::println(out, "      \"dc\": {{\"solved\": {}, \"stages\": {}}},", result.dcSolved, stageTimes(result.dc));
+		std::println(out, "      \"ac\": {{\"solved\": {}, \"stages\": {}}}", result.acSolved, stageTimes(result.ac));
+		std::println(out, "    }}{}", static_cast<size_t>(index) + 1 == results.size() ? "" : ",");
+	}
+	std::println(out, "  ]");
+	std::println(out, "}}");
+}
+
+int main(int argc, char **argv) {
+	const auto options = parseArguments(std::span(argv, static_cast<size_t>(argc)).subspan(1));
+	if (!options) {
+		std::print(stderr, "{}", usage);
+		return 1;
+	}
+
+	std::vector<CircuitGenerators::Generator> generators{};
+	if (options->generators.empty()) {
+		generators = CircuitGenerators::generators;
+	} else {
+		for (const auto &name: options->generators) {
+			const auto it = std::ranges::find(CircuitGenerators::generators, name, &CircuitGenerators::Generator::name);
+			if (it == CircuitGenerators::generators.end()) {
+				std::println(stderr, "Unknown generator: {}", name);
+				return 1;
+			}
+			generators.emplace_back(*it);
+		}
+	}
+
+	GraphDescriptor::verbose = false;
+
+	std::vector<CaseResult> results{};
+	for (const auto &generator: generators) {
+		for (const auto &size: options->sizes) {
+			auto &result = results.emplace_back(CaseResult{.generator = generator.name, .targetElements = size});
+			std::println(stderr, "{} with {} elements", generator.name, size);
+
+			BoardStorage board{};
+			generator.build(board, size);
+			result.elements = board.elements.size() + board.lines.size();
+
+			for (uint32_t repetition = 0; repetition < options->repetitions; repetition++) {
+				const auto extractionStart = Clock::now();
+				const GraphDescriptor graph{board};
+				result.extraction.emplace_back(milliseconds(Clock::now() - extractionStart));
+				result.nodes = graph.nodeCount;
+
+				const auto parallelStart = Clock::now();
+				const GraphDescriptor parallelGraph{board, &ThreadPool::shared()};
+				result.parallelExtraction.emplace_back(milliseconds(Clock::now() - parallelStart));
+
+				const auto canonicalStart = Clock::now();
+				const CanonicalNetlist netlist{graph};
+				result.canonicalization.emplace_back(milliseconds(Clock::now() - canonicalStart));
+
+				// Fresh systems every time so the symbolic analysis is part of every run,
+				// they are destroyed outside of the timed part
+				std::optional<MnaSystem<double>> dcSystem{};
+				std::optional<MnaSystem<std::complex<float>>> acSystem{};
+				result.dcSolved = timeStages<DCSimulation>(result.dc, [&](SimulationProgress &progress) {
+					return DCSimulation{graph, dcSystem, &progress};
+				}) && result.dcSolved;
+				result.acSolved = timeStages<ACSimulation>(result.ac, [&](SimulationProgress &progress) {
+					return ACSimulation{graph, acSystem, options->frequency, &progress};
+				}) && result.acSolved;
+			}
+		}
+	}
+
+	if (options->output.empty()) {
+		write(stdout, results, *options);
+	} else {
+		std::FILE *out = std::fopen(options->output.string().c_str(), "w");
+		if (!out) {
+			std::println(stderr, "Failed to open {}", options->output.string());
+			return 1;
+		}
+		write(out, results, *options);
+		std::fclose(out);
+	}
+
+	return 0;
+}
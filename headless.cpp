@@ -0,0 +1,641 @@
+#include "acSimulation.hpp"
+#include "acSweep.hpp"
+#include "boardStorage.hpp"
+#include "dcSimulation.hpp"
+#include "graphDescriptor.hpp"
+#include "loopAnalysis.hpp"
+#include "monteCarlo.hpp"
+#include "parametricSweep.hpp"
+#include "spiceNetlist.hpp"
+#include "threadPool.hpp"
+#include "transientSimulation.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <filesystem>
+#include <functional>
+#include <numbers>
+#include <optional>
+#include <print>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Runs simulations on .sqcs files and SPICE decks without a window, textures or widgets
+// Meant for batch runs and for timing the simulation path on its own
+
+static constexpr std::string_view usage = R"(Usage: CircuitSimulatorHeadless [options] <file.sqcs|file.cir>...
+SPICE decks (.cir, .sp, .spice, .net, .ckt) are read straight into a netlist
+Options:
+  --analysis <dc|ac|loops|sweep|transient|montecarlo|parametric>
+                              Analysis to run, loops gives the D.C. current of every fundamental loop
+                              and sweep the A.C. response over a range of frequencies (default dc)
+  --frequency <Hz>            Frequency of the A.C. analysis, of the Monte Carlo A.C. trials
+                              and of the A.C. sources in the transient analysis (default 50)
+  --scale <linear|decade|octave>
+                              Spacing of the swept frequencies (default decade)
+  --start <Hz>                First swept frequency (default 1)
+  --stop <Hz>                 Last swept frequency (default 1000000)
+  --points <n>                Swept frequencies, per decade or octave unless linear (default 20)
+  --stop-time <s>             Length of the transient analysis (default 0.1)
+  --time-step <s>             Time step of the transient analysis, the first step when adaptive (default 0.00001)
+  --stride <n>                Only every n-th transient step is written (default 10)
+  --adaptive                  Pick the transient time step from the local truncation error
+  --trials <n>                Monte Carlo trials (default 1000)
+  --seed <n>                  Seed of the Monte Carlo trials (default 1)
+  --trial-analysis <dc|ac>    Analysis repeated by the Monte Carlo trials, ac gives magnitudes (default dc)
+  --parameter <id>,<property>,<start>,<stop>,<count>
+                              Property of an element the parametric analysis sweeps over count evenly spaced values,
+                              repeat it to sweep the grid of several properties
+  --format <text|csv|json>    Output format (default text)
+  --output <path>             Write the results to a file instead of stdout
+  --timing                    Print the load, extraction and simulation times to stderr
+  --export <dir>              Also write the netlist of every file as a SPICE deck into the directory
+)";
+
+enum class Format {
+	text,
+	csv,
+	json,
+};
+
+struct Options {
+	std::string_view analysis = "dc";
+	float frequency = 50.f;
+	ACSweep::Settings sweep{};
+	TransientSimulation::Settings transient{};
+	MonteCarlo::Settings monteCarlo{};
+	std::vector<ParametricSweep::Parameter> parameters{};
+	Format format = Format::text;
+	std::filesystem::path output{};
+	bool timing = false;
+	std::filesystem::path exportDirectory{};
+	std::vector<std::filesystem::path> files{};
+};
+
+// A node voltage or an element current, D.C. values have no imaginary part
+struct Value {
+	std::string_view quantity;
+	// Node index for voltages, element id for currents, for the element that closes a loop and for the swept element
+	uint32_t index;
+	std::complex<float> value;
+	// Swept variable of the point the value belongs to, only used by analyses with more than one point
+	float at = 0.f;
+	// Which statistic of the value this is, only used by analyses that reduce many runs
+	std::string_view statistic{};
+};
+
+struct FileResult {
+	std::filesystem::path file;
+	bool ok = false;
+	std::vector<Value> values{};
+};
+
+// New analyses only need an entry here, they get the graph and return their values
+struct Analysis {
+	std::string_view name;
+	bool complex;
+	// Name of the swept variable, empty for analyses that give a single point
+	std::string_view variable{};
+	bool statistics = false;
+	std::function<std::vector<Value>(const GraphDescriptor &, const Options &)> run;
+};
+
+// One point of a sweep, taken out of the traces so it goes through collect like a single simulation
+struct Point {
+	struct Current {
+		ElementId id;
+		std::complex<float> value;
+	};
+
+	std::vector<std::complex<float>> voltages{};
+	std::vector<Current> currents{};
+};
+
+template<class T>
+static void collect(std::vector<Value> &ret, const T &simulation, float at = 0.f, std::string_view statistic = {}) {
+	ret.reserve(ret.size() + simulation.voltages.size() + simulation.currents.size());
+	for (const auto &[index, voltage]: simulation.voltages | std::views::enumerate) {
+		ret.emplace_back(Value{"voltage", static_cast<uint32_t>(index + 1), voltage, at, statistic});
+	}
+	for (const auto &current: simulation.currents) {
+		ret.emplace_back(Value{"current", current.id, current.value, at, statistic});
+	}
+}
+
+template<class T>
+static std::vector<Value> collect(const T &simulation) {
+	std::vector<Value> ret{};
+	collect(ret, simulation);
+	return ret;
+}
+
+// Statistics the Monte Carlo analysis writes for every node and element
+using StatisticGetter = double (*)(const MonteCarlo::Statistics &);
+static const std::array<std::pair<std::string_view, StatisticGetter>, 4> monteCarloStatistics{{
+	{"mean", [](const MonteCarlo::Statistics &statistics) { return statistics.mean; }},
+	{"deviation", [](const MonteCarlo::Statistics &statistics) { return statistics.standardDeviation(); }},
+	{"min", [](const MonteCarlo::Statistics &statistics) { return statistics.min; }},
+	{"max", [](const MonteCarlo::Statistics &statistics) { return statistics.max; }},
+}};
+
+// Solves the middle point of the sweep again as a single D.C. simulation, both have to give the same operating point
+static bool checkSweep(const GraphDescriptor &graph, const ParametricSweep &sweep) {
+	const auto point = sweep.pointCount / 2;
+	GraphDescriptor pointGraph = graph;
+	for (const auto &[parameterIndex, parameter]: sweep.parameters | std::views::enumerate) {
+		pointGraph.valuesOf(*graph.indexOf(parameter.id))[parameter.propertyIndex].value = sweep.parameterValue(point, parameterIndex);
+	}
+	const DCSimulation simulation{pointGraph};
+	const auto voltages = sweep.pointVoltages(point);
+	// The point failed in the sweep too, there is nothing to compare
+	if (!simulation.converged || std::ranges::any_of(voltages, [](float value) { return std::isnan(value); })) return true;
+	for (const auto &[index, voltage]: simulation.voltages | std::views::enumerate) {
+		const auto sweptVoltage = voltages[static_cast<size_t>(index)];
+		if (std::abs(sweptVoltage - voltage) > 1e-4f * std::max(std::abs(sweptVoltage), std::abs(voltage)) + 1e-6f) {
+			std::println(stderr, "Parametric sweep: point {} gives {}V on node {}, a single D.C. run gives {}V", point, sweptVoltage, index + 1, voltage);
+			return false;
+		}
+	}
+	return true;
+}
+
+static const std::vector<Analysis> analyses{
+	Analysis{
+		.name = "dc",
+		.complex = false,
+		.run = [](const GraphDescriptor &graph, const Options &) {
+			return collect(DCSimulation{graph});
+		},
+	},
+	Analysis{
+		.name = "ac",
+		.complex = true,
+		.run = [](const GraphDescriptor &graph, const Options &options) {
+			return collect(ACSimulation{graph, options.frequency});
+		},
+	},
+	Analysis{
+		.name = "loops",
+		.complex = false,
+		// D.C. current around every fundamental loop, which is the current of the element that closes the loop
+		.run = [](const GraphDescriptor &graph, const Options &) {
+			std::vector<Value> ret{};
+			const DCSimulation simulation{graph};
+			if (simulation.voltages.empty()) return ret;
+			const auto nodeVoltage = [&](uint32_t node) {
+				return node == 0 ? 0.f : simulation.voltages.at(node - 1);
+			};
+			// Voltage sources, inductors and diodes
+			std::unordered_map<ElementId, float> solvedCurrents{};
+			for (const auto &current: simulation.currents) {
+				solvedCurrents.emplace(current.id, current.value);
+			}
+			// Current through the element from its first pin to its second, capacitors are open
+			const auto elementCurrent = [&](size_t index) {
+				const auto &element = graph.elements.at(index);
+				const auto pins = graph.nodesOf(index);
+				switch (element.component.get().id) {
+					case 3:
+						return element.propertySetIndex == 0 ? graph.value(index, 0) : 0.f;
+					case 4:
+						return (nodeVoltage(pins[0]) - nodeVoltage(pins[1])) / graph.value(index, 0);
+					default: {
+						const auto it = solvedCurrents.find(element.id);
+						return it == solvedCurrents.end() ? 0.f : it->second;
+					}
+				}
+			};
+
+			const LoopAnalysis loops{graph};
+			ret.reserve(loops.chords.size());
+			for (const auto &chord: loops.chords) {
+				// Loops are named after the element that closes them
+				ret.emplace_back(Value{"loop", graph.elements.at(chord).id, elementCurrent(chord)});
+			}
+			return ret;
+		},
+	},
+	Analysis{
+		.name = "sweep",
+		.complex = true,
+		.variable = "frequency",
+		.run = [](const GraphDescriptor &graph, const Options &options) {
+			std::vector<Value> ret{};
+			const ACSweep sweep{graph, options.sweep};
+			if (sweep.voltages.empty()) return ret;
+			const auto phasor = [](const ACSweep::Trace &trace, size_t point) {
+				return std::polar(trace.magnitude.at(point), trace.phase.at(point) * std::numbers::pi_v<float> / 180.f);
+			};
+			for (const auto &[point, frequency]: sweep.frequencies | std::views::enumerate) {
+				Point values{};
+				for (const auto &trace: sweep.voltages) {
+					values.voltages.emplace_back(phasor(trace, static_cast<size_t>(point)));
+				}
+				for (const auto &current: sweep.currents) {
+					values.currents.emplace_back(Point::Current{current.id, phasor(current.trace, static_cast<size_t>(point))});
+				}
+				collect(ret, values, frequency);
+			}
+			return ret;
+		},
+	},
+	Analysis{
+		.name = "transient",
+		.complex = false,
+		.variable = "time",
+		.run = [](const GraphDescriptor &graph, const Options &options) {
+			std::vector<Value> ret{};
+			auto settings = options.transient;
+			settings.sourceFrequency = options.frequency;
+			const TransientSimulation transient{graph, settings};
+			for (const auto &[point, time]: transient.times | std::views::enumerate) {
+				Point values{};
+				for (const auto &trace: transient.voltages) {
+					values.voltages.emplace_back(trace.at(static_cast<size_t>(point)));
+				}
+				for (const auto &current: transient.currents) {
+					values.currents.emplace_back(Point::Current{current.id, current.values.at(static_cast<size_t>(point))});
+				}
+				collect(ret, values, time);
+			}
+			return ret;
+		},
+	},
+	Analysis{
+		.name = "montecarlo",
+		.complex = false,
+		.statistics = true,
+		// Every node and element gets its mean, standard deviation, minimum and maximum over the trials
+		.run = [](const GraphDescriptor &graph, const Options &options) {
+			std::vector<Value> ret{};
+			auto settings = options.monteCarlo;
+			settings.frequency = options.frequency;
+			const MonteCarlo monteCarlo{graph, settings};
+			if (monteCarlo.voltages.empty()) return ret;
+			for (const auto &[name, statistic]: monteCarloStatistics) {
+				Point values{};
+				for (const auto &summary: monteCarlo.voltages) {
+					values.voltages.emplace_back(static_cast<float>(statistic(summary.statistics)));
+				}
+				for (const auto &current: monteCarlo.currents) {
+					values.currents.emplace_back(Point::Current{current.id, static_cast<float>(statistic(current.summary.statistics))});
+				}
+				collect(ret, values, 0.f, name);
+			}
+			return ret;
+		},
+	},
+	Analysis{
+		.name = "parametric",
+		.complex = false,
+		.variable = "point",
+		// D.C. operating point of every combination of the parameter values, each point starts with the values of its parameters
+		.run = [](const GraphDescriptor &graph, const Options &options) {
+			std::vector<Value> ret{};
+			const ParametricSweep sweep{graph, options.parameters};
+			if (sweep.voltages.empty() || !checkSweep(graph, sweep)) return ret;
+			for (size_t point = 0; point < sweep.pointCount; point++) {
+				const auto at = static_cast<float>(point);
+				for (const auto &[parameterIndex, parameter]: sweep.parameters | std::views::enumerate) {
+					ret.emplace_back(Value{"parameter", parameter.id, sweep.parameterValue(point, parameterIndex), at});
+				}
+				Point values{};
+				values.voltages.assign(sweep.pointVoltages(point).begin(), sweep.pointVoltages(point).end());
+				for (const auto &[id, current]: std::views::zip(sweep.currentIds, sweep.pointCurrents(point))) {
+					values.currents.emplace_back(Point::Current{id, current});
+				}
+				collect(ret, values, at);
+			}
+			return ret;
+		},
+	},
+};
+
+// Parses "<id>,<property>,<start>,<stop>,<count>" into count evenly spaced values from start to stop
+static std::optional<ParametricSweep::Parameter> parseParameter(std::string_view value) {
+	std::vector<std::string_view> fields{};
+	for (const auto &field: value | std::views::split(',')) {
+		fields.emplace_back(field.begin(), field.end());
+	}
+	if (fields.size() != 5) return std::nullopt;
+	const auto number = [](std::string_view field, auto &out) {
+		const auto [ptr, error] = std::from_chars(field.data(), field.data() + field.size(), out);
+		return error == std::errc{} && ptr == field.data() + field.size();
+	};
+
+	ParametricSweep::Parameter ret{};
+	float start = 0.f;
+	float stop = 0.f;
+	uint32_t count = 0;
+	if (!number(fields[0], ret.id) || !number(fields[1], ret.propertyIndex) || !number(fields[2], start) || !number(fields[3], stop) || !number(fields[4], count) || count == 0) {
+		return std::nullopt;
+	}
+	ret.values.reserve(count);
+	for (uint32_t i = 0; i < count; i++) {
+		ret.values.emplace_back(count == 1 ? start : start + (stop - start) * static_cast<float>(i) / static_cast<float>(count - 1));
+	}
+	return ret;
+}
+
+static std::optional<Options> parseArguments(std::span<char *> args) {
+	Options ret{};
+	for (size_t i = 0; i < args.size(); i++) {
+		const std::string_view arg{args[i]};
+		const auto next = [&]() -> std::optional<std::string_view> {
+			if (i + 1 >= args.size()) {
+				std::println(stderr, "Missing value for {}", arg);
+				return std::nullopt;
+			}
+			return args[++i];
+		};
+		// Reads the value of a numeric option into out
+		const auto nextNumber = [&](auto &out) {
+			const auto value = next();
+			if (!value) return false;
+			const auto [ptr, error] = std::from_chars(value->data(), value->data() + value->size(), out);
+			if (error != std::errc{} || ptr != value->data() + value->size()) {
+				std::println(stderr, "Invalid value for {}: {}", arg, *value);
+				return false;
+			}
+			return true;
+		};
+
+		if (arg == "--analysis") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			ret.analysis = *value;
+		} else if (arg == "--frequency") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			const auto [_, error] = std::from_chars(value->data(), value->data() + value->size(), ret.frequency);
+			if (error != std::errc{}) {
+				std::println(stderr, "Invalid frequency: {}", *value);
+				return std::nullopt;
+			}
+		} else if (arg == "--scale") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			if (*value == "linear") {
+				ret.sweep.scale = ACSweep::Scale::linear;
+			} else if (*value == "decade") {
+				ret.sweep.scale = ACSweep::Scale::decade;
+			} else if (*value == "octave") {
+				ret.sweep.scale = ACSweep::Scale::octave;
+			} else {
+				std::println(stderr, "Unknown scale: {}", *value);
+				return std::nullopt;
+			}
+		} else if (arg == "--start") {
+			if (!nextNumber(ret.sweep.startFrequency)) return std::nullopt;
+		} else if (arg == "--stop") {
+			if (!nextNumber(ret.sweep.stopFrequency)) return std::nullopt;
+		} else if (arg == "--points") {
+			if (!nextNumber(ret.sweep.points)) return std::nullopt;
+		} else if (arg == "--stop-time") {
+			if (!nextNumber(ret.transient.stopTime)) return std::nullopt;
+		} else if (arg == "--time-step") {
+			if (!nextNumber(ret.transient.timeStep)) return std::nullopt;
+		} else if (arg == "--stride") {
+			if (!nextNumber(ret.transient.outputStride)) return std::nullopt;
+		} else if (arg == "--adaptive") {
+			ret.transient.adaptive = true;
+		} else if (arg == "--trials") {
+			if (!nextNumber(ret.monteCarlo.trials)) return std::nullopt;
+		} else if (arg == "--seed") {
+			if (!nextNumber(ret.monteCarlo.seed)) return std::nullopt;
+		} else if (arg == "--trial-analysis") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			if (*value == "dc") {
+				ret.monteCarlo.analysis = MonteCarlo::Analysis::dc;
+			} else if (*value == "ac") {
+				ret.monteCarlo.analysis = MonteCarlo::Analysis::ac;
+			} else {
+				std::println(stderr, "Unknown trial analysis: {}", *value);
+				return std::nullopt;
+			}
+		} else if (arg == "--parameter") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			auto parameter = parseParameter(*value);
+			if (!parameter) {
+				std::println(stderr, "Invalid parameter: {}", *value);
+				return std::nullopt;
+			}
+			ret.parameters.emplace_back(std::move(*parameter));
+		} else if (arg == "--format") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			if (*value == "text") {
+				ret.format = Format::text;
+			} else if (*value == "csv") {
+				ret.format = Format::csv;
+			} else if (*value == "json") {
+				ret.format = Format::json;
+			} else {
+				std::println(stderr, "Unknown format: {}", *value);
+				return std::nullopt;
+			}
+		} else if (arg == "--output") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			ret.output = *value;
+		} else if (arg == "--export") {
+			const auto value = next();
+			if (!value) return std::nullopt;
+			ret.exportDirectory = *value;
+		} else if (arg == "--timing") {
+			ret.timing = true;
+		} else if (arg.starts_with("--")) {
+			std::println(stderr, "Unknown option: {}", arg);
+			return std::nullopt;
+		} else {
+			ret.files.emplace_back(arg);
+		}
+	}
+	return ret;
+}
+
+static bool isSpiceDeck(const std::filesystem::path &file) {
+	auto extension = file.extension().string();
+	std::ranges::transform(extension, extension.begin(), [](unsigned char c) {
+		return static_cast<char>(std::tolower(c));
+	});
+	return extension == ".cir" || extension == ".sp" || extension == ".spice" || extension == ".net" || extension == ".ckt";
+}
+
+static std::string jsonString(std::string_view str) {
+	std::string ret{"\""};
+	for (const auto &c: str) {
+		if (c == '"' || c == '\\') {
+			ret += '\\';
+			ret += c;
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			ret += std::format("\\u{:04x}", static_cast<unsigned char>(c));
+		} else {
+			ret += c;
+		}
+	}
+	return ret + '"';
+}
+
+// JSON has no NaN or infinity, failed points are written as null
+static std::string jsonNumber(float value) {
+	if (!std::isfinite(value)) return "null";
+	return std::format("{}", value);
+}
+
+static float phaseDegrees(std::complex<float> value) {
+	return std::arg(value) * 180.f / std::numbers::pi_v<float>;
+}
+
+static void write(std::FILE *out, const std::vector<FileResult> &results, const Analysis &analysis, Format format) {
+	const bool swept = !analysis.variable.empty();
+	switch (format) {
+		case Format::text: {
+			for (const auto &result: results) {
+				std::println(out, "{}: {}", result.file.string(), result.ok ? "ok" : "failed");
+				for (const auto &value: result.values) {
+					// Parameters keep the unit of the property they set, which the netlist doesn't have
+					const auto unit = value.quantity == "voltage" ? "V" : value.quantity == "parameter" ? "" : "A";
+					const auto label = value.quantity == "voltage" ? "Node" : value.quantity == "loop" ? "Loop of element" : value.quantity == "parameter" ? "Parameter of element" : "Element";
+					auto point = swept ? std::format("{} {}, ", analysis.variable, value.at) : std::string{};
+					if (analysis.statistics) point += std::format("{}, ", value.statistic);
+					if (analysis.complex) {
+						std::println(out, "  {}{} #{}: {}{} at {}°", point, label, value.index, std::abs(value.value), unit, phaseDegrees(value.value));
+					} else {
+						std::println(out, "  {}{} #{}: {}{}", point, label, value.index, value.value.real(), unit);
+					}
+				}
+			}
+			break;
+		}
+		case Format::csv: {
+			std::println(out, "file,{}{}{}", swept ? std::format("{},", analysis.variable) : std::string{}, analysis.statistics ? "statistic," : "", analysis.complex ? "quantity,index,magnitude,phase" : "quantity,index,value");
+			for (const auto &result: results) {
+				for (const auto &value: result.values) {
+					auto point = swept ? std::format("{},", value.at) : std::string{};
+					if (analysis.statistics) point += std::format("{},", value.statistic);
+					if (analysis.complex) {
+						std::println(out, "{},{}{},{},{},{}", result.file.string(), point, value.quantity, value.index, std::abs(value.value), phaseDegrees(value.value));
+					} else {
+						std::println(out, "{},{}{},{},{}", result.file.string(), point, value.quantity, value.index, value.value.real());
+					}
+				}
+			}
+			break;
+		}
+		case Format::json: {
+			std::println(out, "[");
+			for (const auto &[resultIndex, result]: results | std::views::enumerate) {
+				std::println(out, "  {{\"file\": {}, \"analysis\": {}, \"ok\": {}, \"values\": [", jsonString(result.file.string()), jsonString(analysis.name), result.ok);
+				for (const auto &[index, value]: result.values | std::views::enumerate) {
+					const auto separator = static_cast<size_t>(index) + 1 == result.values.size() ? "" : ",";
+					const auto key = value.quantity == "voltage" ? "node" : "id";
+					auto point = swept ? std::format("{}: {}, ", jsonString(analysis.variable), jsonNumber(value.at)) : std::string{};
+					if (analysis.statistics) point += std::format("\"statistic\": \"{}\", ", value.statistic);
+					if (analysis.complex) {
+						std::println(out, "    {{{}\"quantity\": \"{}\", \"{}\": {}, \"magnitude\": {}, \"phase\": {}}}{}", point, value.quantity, key, value.index, jsonNumber(std::abs(value.value)), jsonNumber(phaseDegrees(value.value)), separator);
+					} else {
+						std::println(out, "    {{{}\"quantity\": \"{}\", \"{}\": {}, \"value\": {}}}{}", point, value.quantity, key, value.index, jsonNumber(value.value.real()), separator);
+					}
+				}
+				std::println(out, "  ]}}{}", static_cast<size_t>(resultIndex) + 1 == results.size() ? "" : ",");
+			}
+			std::println(out, "]");
+			break;
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	const auto options = parseArguments(std::span(argv, static_cast<size_t>(argc)).subspan(1));
+	if (!options || options->files.empty()) {
+		std::print(stderr, "{}", usage);
+		return 1;
+	}
+	const auto analysis = std::ranges::find(analyses, options->analysis, &Analysis::name);
+	if (analysis == analyses.end()) {
+		std::println(stderr, "Unknown analysis: {}", options->analysis);
+		return 1;
+	}
+
+	// The debug dump of every extracted graph would end up mixed with the results
+	GraphDescriptor::verbose = false;
+
+	using Clock = std::chrono::steady_clock;
+	const auto milliseconds = [](Clock::duration duration) {
+		return std::chrono::duration<double, std::milli>(duration).count();
+	};
+
+	std::vector<FileResult> results{};
+	results.reserve(options->files.size());
+	bool allOk = true;
+	for (const auto &file: options->files) {
+		auto &result = results.emplace_back(FileResult{.file = file});
+
+		const auto loadStart = Clock::now();
+		std::optional<GraphDescriptor> graph{};
+		auto extractionStart = loadStart;
+		if (isSpiceDeck(file)) {
+			graph = SpiceNetlist::read(file);
+			extractionStart = Clock::now();
+		} else {
+			BoardStorage board{};
+			if (board.loadFromFile(file)) {
+				extractionStart = Clock::now();
+				graph.emplace(board, &ThreadPool::shared());
+			}
+		}
+		if (!graph.has_value()) {
+			std::println(stderr, "Failed to load {}", file.string());
+			allOk = false;
+			continue;
+		}
+
+		const auto simulationStart = Clock::now();
+		result.values = analysis->run(*graph, *options);
+		const auto simulationEnd = Clock::now();
+
+		result.ok = !result.values.empty();
+		allOk = allOk && result.ok;
+		if (options->timing) {
+			std::println(
+				stderr,
+				"{}: load {:.3f}ms, extraction {:.3f}ms, simulation {:.3f}ms",
+				file.string(),
+				milliseconds(extractionStart - loadStart),
+				milliseconds(simulationStart - extractionStart),
+				milliseconds(simulationEnd - simulationStart)
+			);
+		}
+		if (!options->exportDirectory.empty()) {
+			const auto path = options->exportDirectory / file.filename().replace_extension(".cir");
+			if (!SpiceNetlist::write(path, *graph)) {
+				std::println(stderr, "Failed to write {}", path.string());
+				allOk = false;
+			}
+		}
+	}
+
+	if (options->output.empty()) {
+		write(stdout, results, *analysis, options->format);
+	} else {
+		std::FILE *out = std::fopen(options->output.string().c_str(), "w");
+		if (!out) {
+			std::println(stderr, "Failed to open {}", options->output.string());
+			return 1;
+		}
+		write(out, results, *analysis, options->format);
+		std::fclose(out);
+	}
+
+	return allOk ? 0 : 1;
+}
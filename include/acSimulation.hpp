@@ -1,15 +1,23 @@
 #pragma once
 #include "graphDescriptor.hpp"
+#include "mnaSystem.hpp"
+#include "simulationProgress.hpp"
 
+// Diodes have no small signal model yet, circuits with diodes are refused and leave the results empty
 struct ACSimulation {
 	struct Result {
 		ElementId id{};
 		std::complex<float> value;
 	};
+	float frequency = 50.f;
 	std::vector<Result> currents{};
 	std::vector<std::complex<float>> voltages{};
 
-	ACSimulation(const GraphDescriptor &);
+	ACSimulation(const GraphDescriptor &, float frequency = 50.f);
+	// Reuses the symbolic analysis of system if the topology is the same, replaces it otherwise
+	// progress is optional, it gets the current stage and can cancel the simulation, leaving the results empty
+	ACSimulation(const GraphDescriptor &, std::optional<MnaSystem<std::complex<float>>> &system, float frequency = 50.f, SimulationProgress *progress = nullptr, MnaRefactor refactor = MnaRefactor::incremental);
 
-	[[nodiscard]] static Eigen::MatrixXf generateIncidenceMatrix(const GraphDescriptor &graph);
+	// Branch values of the topology at the given frequency, in the format MnaSystem::refactor expects
+	[[nodiscard]] static std::vector<std::complex<float>> branchValues(const GraphDescriptor &graph, const MnaTopology &topology, float frequency);
 };
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+#include "graphDescriptor.hpp"
+#include "mnaSystem.hpp"
+#include "simulationProgress.hpp"
+
+// Small signal frequency sweep (Bode analysis) of the A.C. circuit
+// Like ACSimulation it refuses circuits with diodes
+struct ACSweep {
+	enum class Scale {
+		linear,
+		decade,
+		octave,
+	};
+
+	struct Settings {
+		Scale scale = Scale::decade;
+		float startFrequency = 1.f;
+		float stopFrequency = 1'000'000.f;
+		// Total point count for linear sweeps, points per decade/octave otherwise
+		uint32_t points = 20;
+
+		[[nodiscard]] std::vector<float> frequencies() const;
+	};
+
+	// Magnitude and phase (in degrees) for every swept frequency
+	struct Trace {
+		std::vector<float> magnitude{};
+		std::vector<float> phase{};
+	};
+
+	struct CurrentTrace {
+		ElementId id;
+		Trace trace;
+	};
+
+	Settings settings{};
+	std::vector<float> frequencies{};
+	// One trace per node, without the ground node
+	std::vector<Trace> voltages{};
+	// One trace per voltage source
+	std::vector<CurrentTrace> currents{};
+
+	ACSweep(const GraphDescriptor &, const Settings &);
+	// Reuses the symbolic analysis of system if the topology is the same, replaces it otherwise
+	// progress is optional, it gets the done fraction of the points and can cancel the sweep, leaving the results empty
+	ACSweep(const GraphDescriptor &, const Settings &, std::optional<MnaSystem<std::complex<float>>> &system, SimulationProgress *progress = nullptr);
+};
\ No newline at end of file
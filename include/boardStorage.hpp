@@ -3,7 +3,9 @@
 #include "connection.hpp"
 #include "coords.hpp"
 #include "element.hpp"
-#include "widget.hpp"
+#include "gridIndex.hpp"
+#include "netIndex.hpp"
+#include <filesystem>
 #include <functional>
 #include <print>
 #include <unordered_map>
@@ -15,13 +17,29 @@ struct BoardStorage {
 	std::vector<ElementData> lines{};
 	std::vector<ElementData> elements{};
 
-	std::unordered_map<Coords, std::vector<ElementId>> lineTiles{};
+	// Lines are only indexed by the rows and columns they run along, long wires cost as much as short ones
+	SegmentIndex lineSegments{};
 	std::unordered_map<Coords, std::vector<ElementId>> elementTiles{};
 
 	std::unordered_map<Coords, ConnectionNode> connections{};
+	// Kept up to date by the place and remove functions
+	NetIndex nets{};
 
-	void save();
-	void load();
+	// Lets the editor keep its widgets in sync with the board, headless boards leave them empty
+	struct Listeners {
+		std::function<void(const Element &)> elementPlaced;
+		std::function<void(const Element &)> linePlaced;
+		std::function<void(ElementId)> elementRemoved;
+		std::function<void(ElementId)> lineRemoved;
+		// Called for every node of a placed element or line, even if the connection node already existed
+		std::function<void(const Coords &)> connectionPlaced;
+		std::function<void()> cleared;
+	} listeners{};
+
+	// Returns false if the file couldn't be written
+	bool saveToFile(const std::filesystem::path &path) const;
+	// Replaces the board with the contents of a save file, returns false if it couldn't be read
+	bool loadFromFile(const std::filesystem::path &path);
 
 	static std::vector<ElementData>::const_iterator lower_bound(const std::vector<ElementData> &rng, ElementId id);
 	static std::vector<ElementData>::const_iterator upper_bound(const std::vector<ElementData> &rng, ElementId id);
@@ -32,9 +50,15 @@ struct BoardStorage {
 
 	[[nodiscard]] std::optional<std::reference_wrapper<const ElementData>> getClosestElementData(const std::vector<ElementId> &ids, const Coords &coords) const;
 
-	static squi::Child createNodeChild(const Coords &coords);
+	struct BoxSelection {
+		std::vector<ElementId> elements{};
+		std::vector<ElementId> lines{};
+	};
+	// Elements and lines with a tile in the box (min inclusive, max exclusive), every id is listed once
+	[[nodiscard]] BoxSelection selectBox(const Coords &min, const Coords &max) const;
 
-	static void ensureConnectionNode(ConnectionNode &node, const Coords &coords);
+	// Copy without the listeners, safe to hand over to another thread while the board keeps being edited
+	[[nodiscard]] BoardStorage snapshot() const;
 
 	void placeLine(const Element &elem);
 
@@ -43,4 +67,7 @@ struct BoardStorage {
 	void placeElement(const Element &elem);
 
 	void removeElement(ElementId id);
+
+	// Called after the properties of an element were edited in place
+	void propertiesChanged(ElementId id);
 };
\ No newline at end of file
@@ -2,18 +2,24 @@
 
 #include "coords.hpp"
 #include "elementProperty.hpp"
-#include "samplerUniform.hpp"
 #include <cstdint>
-#include <optional>
 #include <vector>
 
 
 enum class ElementType {
 	Line,
 	Ground,
+	// Joins every point with a label of the same name (see NetIndex::labelOf)
+	Label,
 	Other,
 };
 
+// Texture coordinates, kept as plain floats so the simulation core doesn't need the renderer's vector type
+struct Uv {
+	float x = 0.f;
+	float y = 0.f;
+};
+
 struct Component {
 	uint32_t id = 0;
 	std::string name;
@@ -22,12 +28,11 @@ struct Component {
 	uint32_t height;
 	ElementType type = ElementType::Other;
 	std::vector<Coords> nodes{};
+	// The editor loads its textures from these (see ComponentTextures)
 	std::string texturePath;
 	std::string textureThumbPath;
-	std::optional<Engine::SamplerUniform> texture{};
-	std::optional<Engine::SamplerUniform> textureThumb{};
-	squi::vec2 uvTopLeft{0, 0};
-	squi::vec2 uvBottomRight{1, 1};
+	Uv uvTopLeft{0.f, 0.f};
+	Uv uvBottomRight{1.f, 1.f};
 	bool hidden = false;
 	std::vector<PropertySet> properties{};
 };
\ No newline at end of file
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "../property/propertyUtils.hpp"
+
+// Anode on the top node, cathode on the bottom node
+static const Component diode{
+	.name = "Diode",
+	.prefix = "D",
+	.width = 2,
+	.height = 4,
+	.nodes{
+		Coords{
+			.x = 1,
+			.y = 0,
+		},
+		Coords{
+			.x = 1,
+			.y = 4,
+		},
+	},
+	.texturePath = R"(./assets/diode.png)",
+	.textureThumbPath = R"(./assets/diodeThumb.png)",
+	.properties{
+		PropertySet{
+			.properties{
+				PropertyData{
+					.name{"Saturation current"},
+					.suffix{"A"},
+					.type = PropertyIndexOf<NumberProperty>,
+					.defaultValue = 1e-14f,
+				},
+				PropertyData{
+					.name{"Emission coefficient"},
+					.type = PropertyIndexOf<NumberProperty>,
+					.defaultValue = 1.f,
+				},
+			},
+		},
+	},
+};
\ No newline at end of file
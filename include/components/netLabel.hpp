@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../property/propertyUtils.hpp"
+
+// Joins every point that has a net label with the same name, without a wire between them
+static const Component netLabel{
+	.name = "Net Label",
+	.width = 2,
+	.height = 2,
+	.type = ElementType::Label,
+	.nodes{
+		Coords{
+			.x = 1,
+			.y = 2,
+		},
+	},
+	.texturePath = R"(./assets/netLabel.png)",
+	.textureThumbPath = R"(./assets/netLabel.png)",
+	.properties{
+		PropertySet{
+			.properties{
+				PropertyData{
+					.name{"Net"},
+					// The board shows the name of the label instead
+					.displayable = false,
+					.type = PropertyIndexOf<TextProperty>,
+					.defaultText = "Net 1",
+				},
+			},
+		},
+	},
+};
\ No newline at end of file
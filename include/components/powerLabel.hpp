@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../property/propertyUtils.hpp"
+
+// Global supply net, the chosen property set is the name of the net
+static const Component powerLabel{
+	.name = "Power Label",
+	.width = 2,
+	.height = 2,
+	.type = ElementType::Label,
+	.nodes{
+		Coords{
+			.x = 1,
+			.y = 2,
+		},
+	},
+	.texturePath = R"(./assets/powerLabel.png)",
+	.textureThumbPath = R"(./assets/powerLabel.png)",
+	.properties{
+		PropertySet{
+			.name = "VCC",
+		},
+		PropertySet{
+			.name = "VDD",
+		},
+		PropertySet{
+			.name = "VEE",
+		},
+		PropertySet{
+			.name = "VSS",
+		},
+	},
+};
\ No newline at end of file
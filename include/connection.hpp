@@ -1,19 +1,11 @@
 #pragma once
 
 #include "element.hpp"
-#include "widget.hpp"
 
 
+// The widgets live in the editor (BoardView), this only holds what the simulation needs
 struct ElementData {
 	Element element;
-	squi::Child widget;
-};
-
-struct LineData {
-	Coords startPos;
-	Coords endPos;
-	Element element;
-	squi::Child widget;
 };
 
 struct Connection {
@@ -27,6 +19,5 @@ struct Connection {
 };
 
 struct ConnectionNode {
-	squi::Child widget;
 	std::vector<Connection> connections{};
 };
\ No newline at end of file
@@ -1,8 +1,8 @@
 #pragma once
 
 #include "functional"
-#include "vec2.hpp"
 #include <algorithm>
+#include <cstdint>
 #include <ostream>
 
 
@@ -52,22 +52,15 @@ struct Coords {
 
 		return os;
 	}
-
-	[[nodiscard]] squi::vec2 toVec() const {
-		return {
-			static_cast<float>(x),
-			static_cast<float>(y),
-		};
-	}
 };
 
 namespace std {
 	template<>
 	struct hash<Coords> {
 		std::size_t operator()(const Coords &coords) const {
-			std::size_t h1 = std::hash<int>{}(coords.x);
-			std::size_t h2 = std::hash<int>{}(coords.y);
-			return h1 ^ (h2 << 1);
+			// Both halves packed into one key, xoring the two hashes made nearby tiles collide a lot
+			const auto packed = (static_cast<uint64_t>(static_cast<uint32_t>(coords.x)) << 32) | static_cast<uint32_t>(coords.y);
+			return std::hash<uint64_t>{}(packed * 0x9E3779B97F4A7C15ull);
 		}
 	};
 }// namespace std
\ No newline at end of file
@@ -1,15 +1,33 @@
 #pragma once
 #include "graphDescriptor.hpp"
+#include "mnaSystem.hpp"
+#include "simulationProgress.hpp"
 
 struct DCSimulation {
 	struct Result {
 		ElementId id;
 		float value;
 	};
+	// How the operating point was found
+	enum class Strategy {
+		// No nonlinear elements, a single solve
+		linear,
+		newton,
+		// Newton from a solution with a large shunt conductance on every node, lowered step by step
+		gminStepping,
+		// Newton from a solution with the sources scaled down, raised step by step
+		sourceStepping,
+	};
+	// One result per voltage source and inductor, followed by one per diode
 	std::vector<Result> currents{};
 	std::vector<float> voltages{};
+	Strategy strategy = Strategy::linear;
+	bool converged = false;
+	// Newton-Raphson iterations over every strategy that was tried, each one is a refactor + solve
+	uint32_t iterations = 0;
 
 	DCSimulation(const GraphDescriptor &);
-
-	[[nodiscard]] static Eigen::MatrixXf generateIncidenceMatrix(const GraphDescriptor &graph);
+	// Reuses the symbolic analysis of system if the topology is the same, replaces it otherwise
+	// progress is optional, it gets the current stage and can cancel the simulation, leaving the results empty
+	DCSimulation(const GraphDescriptor &, std::optional<MnaSystem<double>> &system, SimulationProgress *progress = nullptr, MnaRefactor refactor = MnaRefactor::incremental);
 };
\ No newline at end of file
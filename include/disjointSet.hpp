@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+// Union-find over dense indices, with path halving and union by size
+// Nothing recurses, so it works the same on boards of any size
+struct DisjointSet {
+	std::vector<uint32_t> parent{};
+	std::vector<uint32_t> size{};
+
+	// Adds a new set with a single member and returns its index
+	uint32_t add() {
+		const auto index = static_cast<uint32_t>(parent.size());
+		parent.emplace_back(index);
+		size.emplace_back(1);
+		return index;
+	}
+
+	void reserve(size_t count) {
+		parent.reserve(count);
+		size.reserve(count);
+	}
+
+	// Adds sets until there are count of them
+	void resize(size_t count) {
+		const auto first = static_cast<uint32_t>(parent.size());
+		parent.resize(count);
+		size.resize(count, 1);
+		for (auto index = first; index < count; index++) parent[index] = index;
+	}
+
+	[[nodiscard]] uint32_t find(uint32_t index) {
+		while (parent[index] != index) {
+			parent[index] = parent[parent[index]];
+			index = parent[index];
+		}
+		return index;
+	}
+
+	// Same as find without shortening the path, so several threads can call it once the sets stop changing
+	[[nodiscard]] uint32_t root(uint32_t index) const {
+		while (parent[index] != index) index = parent[index];
+		return index;
+	}
+
+	// Returns the representative of the merged set
+	uint32_t unite(uint32_t a, uint32_t b) {
+		a = find(a);
+		b = find(b);
+		if (a == b) return a;
+		if (size[a] < size[b]) std::swap(a, b);
+		parent[b] = a;
+		size[a] += size[b];
+		return a;
+	}
+};
\ No newline at end of file
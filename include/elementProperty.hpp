@@ -10,6 +10,9 @@ struct PropertyData {
     std::string suffix;
     bool displayable = true;
     PropertyIndex type;
+    // Value of a freshly placed element
+    float defaultValue = 0.f;
+    std::string defaultText{};
 };
 
 struct PropertySet {
@@ -1,65 +1,87 @@
 #pragma once
 
 #include "boardStorage.hpp"
+#include "component.hpp"
 #include "element.hpp"
-#include "unordered_set"
+#include <optional>
+#include <span>
+#include <vector>
 
 
-struct GraphDescriptor {
-	GraphDescriptor(BoardStorage &);
+struct ThreadPool;
 
+// Flat netlist of the board, everything lives in a few contiguous arrays and is linked by indices
+// The order of the elements and the nodes only depends on the circuit, so every run assembles the same system
+struct GraphDescriptor {
+	// With a pool the pins of large boards are resolved in parallel, the netlist comes out the same either way
+	GraphDescriptor(BoardStorage &, ThreadPool *pool = nullptr);
+	// Empty netlist, for netlists that don't come from a board (see NetlistBuilder)
+	GraphDescriptor() = default;
 
-private:
-	void exploreBoard(BoardStorage &);
+	// Prints the extracted graph, the headless runner turns it off so only the results end up on stdout
+	static inline bool verbose = true;
 
-	struct ExpandNodeResult {
-		std::vector<std::reference_wrapper<const Element>> elements{};
-		std::vector<std::reference_wrapper<const Element>> lines{};
-	};
 	struct GraphElement {
-		Element element;
-		mutable std::vector<uint32_t> nodes = std::vector<uint32_t>(element.component.get().nodes.size());
-
-		bool operator==(const GraphElement &other) const {
-			return element.id == other.element.id;
-		}
-	};
-	struct GraphElementHasher {
-		size_t operator()(const GraphElement &elem) const {
-			return std::hash<uint32_t>{}(elem.element.id);
-		}
-	};
-	struct ElementHasher {
-		size_t operator()(const Element &elem) const {
-			return std::hash<uint32_t>{}(elem.id);
-		}
-	};
-	struct Node {
-		std::unordered_set<Element, ElementHasher> elements{};
-		std::unordered_set<Element, ElementHasher> lines{};
-	};
-	struct ExplorationState {
-		uint32_t nodeIdCounter = 0;
-		const BoardStorage &board;
-		std::unordered_set<Coords> exploredConnections{};
+		std::reference_wrapper<const Component> component;
+		ElementId id;
+		uint32_t propertySetIndex;
 	};
+	// Numeric part of a property, the names and suffixes stay with the component
+	struct Value {
+		float value;
+		float tolerance;
+		NumberProperty::Distribution distribution;
 
-	struct ExpandArgs {
-		const size_t nodeIndex;
-		ExpandNodeResult ret{};
-		std::unordered_set<uint32_t> locallyExploredLines{};
-		ExplorationState &state;
-		GraphDescriptor &self;
+		bool operator==(const Value &other) const = default;
 	};
 
-	GraphDescriptor::ExpandNodeResult
-	expandNode(
-		size_t nodeIndex,
-		const Coords &coords,
-		ExplorationState &state
-	);
+	// Sorted by component id and then by element id
+	std::vector<GraphElement> elements{};
+	// The elements of component c are elements[componentOffsets[c]] to elements[componentOffsets[c + 1]]
+	std::vector<uint32_t> componentOffsets{};
+	// Node of every pin, the pins of element i start at pinOffsets[i]
+	std::vector<uint32_t> pinOffsets{};
+	std::vector<uint32_t> pinNodes{};
+	// Property values of element i start at valueOffsets[i]
+	std::vector<uint32_t> valueOffsets{};
+	std::vector<Value> values{};
 
-public:
-	std::unordered_map<ElementId, GraphElement> elements{};
-	std::unordered_map<uint32_t, Node> nodes{};
+	// The ground is node 0
+	uint32_t nodeCount = 0;
+	// Index of every element with a pin on node n, from nodeElementOffsets[n], every element is listed once per node
+	std::vector<uint32_t> nodeElementOffsets{};
+	std::vector<uint32_t> nodeElements{};
+	// Lines, grounds and labels of node n, from nodeLineOffsets[n]
+	std::vector<uint32_t> nodeLineOffsets{};
+	std::vector<ElementId> nodeLines{};
+
+	[[nodiscard]] std::span<const GraphElement> elementsOf(uint32_t componentId) const {
+		if (componentId + 1 >= componentOffsets.size()) return {};
+		return std::span(elements).subspan(componentOffsets[componentId], componentOffsets[componentId + 1] - componentOffsets[componentId]);
+	}
+	[[nodiscard]] std::span<const uint32_t> nodesOf(size_t element) const {
+		return std::span(pinNodes).subspan(pinOffsets[element], pinOffsets[element + 1] - pinOffsets[element]);
+	}
+	[[nodiscard]] std::span<const Value> valuesOf(size_t element) const {
+		return std::span(values).subspan(valueOffsets[element], valueOffsets[element + 1] - valueOffsets[element]);
+	}
+	[[nodiscard]] std::span<Value> valuesOf(size_t element) {
+		return std::span(values).subspan(valueOffsets[element], valueOffsets[element + 1] - valueOffsets[element]);
+	}
+	[[nodiscard]] float value(size_t element, size_t property) const {
+		return values[valueOffsets[element] + property].value;
+	}
+	[[nodiscard]] std::span<const uint32_t> elementsAt(uint32_t node) const {
+		return std::span(nodeElements).subspan(nodeElementOffsets[node], nodeElementOffsets[node + 1] - nodeElementOffsets[node]);
+	}
+	[[nodiscard]] std::span<const ElementId> linesAt(uint32_t node) const {
+		return std::span(nodeLines).subspan(nodeLineOffsets[node], nodeLineOffsets[node + 1] - nodeLineOffsets[node]);
+	}
+	// Index of the element with this id, if it is simulated
+	[[nodiscard]] std::optional<size_t> indexOf(ElementId id) const;
+	// Fills the elements of every node from the pins, once the elements are in place
+	void indexNodes();
+
+private:
+	void exploreBoard(BoardStorage &, ThreadPool *pool);
 };
\ No newline at end of file
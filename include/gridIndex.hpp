@@ -0,0 +1,226 @@
+#pragma once
+
+#include "coords.hpp"
+#include "element.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+
+// Lines of the board by row and by column, a line is a single entry however many tiles it spans
+// Lines are one tile wide, a horizontal one goes into its row and any other one into its column
+struct SegmentIndex {
+	// Tiles start to end, end excluded
+	struct Segment {
+		int32_t start;
+		int32_t end;
+		ElementId id;
+	};
+
+	// Segments of one row or column sorted by their start
+	struct Track {
+		std::vector<Segment> segments{};
+		// Furthest end of the segments up to every index, lets the queries stop before reaching the front
+		std::vector<int32_t> reach{};
+
+		void insert(const Segment &segment) {
+			const auto it = std::ranges::upper_bound(segments, segment.start, {}, &Segment::start);
+			const auto index = static_cast<size_t>(it - segments.begin());
+			segments.insert(it, segment);
+			reach.insert(reach.begin() + static_cast<int64_t>(index), segment.end);
+			updateReach(index);
+		}
+
+		// Returns false if the segment isn't in the track
+		bool erase(const Segment &segment) {
+			auto it = std::ranges::lower_bound(segments, segment.start, {}, &Segment::start);
+			while (it != segments.end() && it->start == segment.start && it->id != segment.id) it++;
+			if (it == segments.end() || it->start != segment.start) return false;
+			const auto index = static_cast<size_t>(it - segments.begin());
+			segments.erase(it);
+			reach.erase(reach.begin() + static_cast<int64_t>(index));
+			updateReach(index);
+			return true;
+		}
+
+		// Ids of the segments sharing a tile with start to end (end excluded), the last ones first
+		void forEachOverlapping(int32_t start, int32_t end, auto &&func) const {
+			const auto it = std::ranges::lower_bound(segments, end, {}, &Segment::start);
+			for (auto index = static_cast<size_t>(it - segments.begin()); index > 0; index--) {
+				if (reach[index - 1] <= start) break;
+				if (segments[index - 1].end > start) func(segments[index - 1].id);
+			}
+		}
+
+	private:
+		// Only the reach from the index onward can change, and it stops changing once a value is already right
+		void updateReach(size_t index) {
+			for (size_t i = index; i < segments.size(); i++) {
+				const auto value = i == 0 ? segments[i].end : std::max(reach[i - 1], segments[i].end);
+				if (i > index && reach[i] == value) break;
+				reach[i] = value;
+			}
+		}
+	};
+
+	std::unordered_map<int32_t, Track> rows{};
+	std::unordered_map<int32_t, Track> columns{};
+	size_t count = 0;
+
+	void add(const Element &line) {
+		const auto [tracks, key, segment] = locate(line);
+		// Lines of zero length have no tiles
+		if (segment.start >= segment.end) return;
+		(this->*tracks)[key].insert(segment);
+		count++;
+	}
+
+	void remove(const Element &line) {
+		const auto [tracks, key, segment] = locate(line);
+		const auto it = (this->*tracks).find(key);
+		if (it == (this->*tracks).end() || !it->second.erase(segment)) return;
+		if (it->second.segments.empty()) (this->*tracks).erase(it);
+		count--;
+	}
+
+	void clear() {
+		rows.clear();
+		columns.clear();
+		count = 0;
+	}
+
+	[[nodiscard]] size_t size() const {
+		return count;
+	}
+
+	// Lines with a tile on the point
+	void forEachAt(const Coords &point, auto &&func) const {
+		if (const auto it = rows.find(point.y); it != rows.end()) it->second.forEachOverlapping(point.x, point.x + 1, func);
+		if (const auto it = columns.find(point.x); it != columns.end()) it->second.forEachOverlapping(point.y, point.y + 1, func);
+	}
+
+	[[nodiscard]] std::vector<ElementId> at(const Coords &point) const {
+		std::vector<ElementId> ret{};
+		forEachAt(point, [&](ElementId id) {
+			ret.emplace_back(id);
+		});
+		return ret;
+	}
+
+	// Lines with a tile in the box (min inclusive, max exclusive), every line is reported once
+	void forEachInBox(const Coords &min, const Coords &max, auto &&func) const {
+		const auto visit = [&](const std::unordered_map<int32_t, Track> &tracks, int32_t first, int32_t last, int32_t start, int32_t end) {
+			if (first >= last || start >= end) return;
+			// Whichever is shorter, the tracks of the board or the rows or columns of the box
+			if (tracks.size() < static_cast<size_t>(last - first)) {
+				for (const auto &[key, track]: tracks) {
+					if (key >= first && key < last) track.forEachOverlapping(start, end, func);
+				}
+				return;
+			}
+			for (auto key = first; key < last; key++) {
+				if (const auto it = tracks.find(key); it != tracks.end()) it->second.forEachOverlapping(start, end, func);
+			}
+		};
+		visit(rows, min.y, max.y, min.x, max.x);
+		visit(columns, min.x, max.x, min.y, max.y);
+	}
+
+private:
+	struct Location {
+		std::unordered_map<int32_t, Track> SegmentIndex::*tracks;
+		int32_t key;
+		Segment segment;
+	};
+
+	static Location locate(const Element &line) {
+		if (line.size.y == 1) return {&SegmentIndex::rows, line.pos.y, Segment{line.pos.x, line.pos.x + line.size.x, line.id}};
+		return {&SegmentIndex::columns, line.pos.x, Segment{line.pos.y, line.pos.y + line.size.y, line.id}};
+	}
+};
+
+// Connection points by row and by column, kept sorted so the points along a line are a single range
+struct PointIndex {
+	std::unordered_map<int32_t, std::vector<int32_t>> rows{};
+	std::unordered_map<int32_t, std::vector<int32_t>> columns{};
+
+	void add(const Coords &point) {
+		insert(rows[point.y], point.x);
+		insert(columns[point.x], point.y);
+	}
+
+	void remove(const Coords &point) {
+		erase(rows, point.y, point.x);
+		erase(columns, point.x, point.y);
+	}
+
+	void clear() {
+		rows.clear();
+		columns.clear();
+	}
+
+	// Adds the points in any order and sorts every row and column once, quicker than adding them one by one
+	// With a pool the rows and the columns fill at the same time and the tracks are sorted in parallel
+	void build(const std::vector<Coords> &points, ThreadPool *pool = nullptr) {
+		clear();
+		const auto forEach = [&](size_t count, auto &&func) {
+			if (pool != nullptr && count > 1) {
+				pool->parallelFor(count, [&](size_t, size_t index) {
+					func(index);
+				});
+			} else {
+				for (size_t index = 0; index < count; index++) func(index);
+			}
+		};
+		forEach(2, [&](size_t index) {
+			for (const auto &point: points) {
+				if (index == 0) {
+					rows[point.y].emplace_back(point.x);
+				} else {
+					columns[point.x].emplace_back(point.y);
+				}
+			}
+		});
+		std::vector<std::vector<int32_t> *> tracks{};
+		tracks.reserve(rows.size() + columns.size());
+		for (auto *map: {&rows, &columns}) {
+			for (auto &[_, track]: *map) tracks.emplace_back(&track);
+		}
+		forEach(tracks.size(), [&](size_t index) {
+			std::ranges::sort(*tracks[index]);
+		});
+	}
+
+	// Points on the tiles of the line
+	void forEachOn(const Element &line, auto &&func) const {
+		const auto visit = [&](const std::unordered_map<int32_t, std::vector<int32_t>> &tracks, int32_t key, int32_t start, int32_t end, bool row) {
+			const auto it = tracks.find(key);
+			if (it == tracks.end()) return;
+			const auto &track = it->second;
+			for (auto value = std::ranges::lower_bound(track, start); value != track.end() && *value < end; value++) {
+				func(row ? Coords{*value, key} : Coords{key, *value});
+			}
+		};
+		if (line.size.y == 1) {
+			visit(rows, line.pos.y, line.pos.x, line.pos.x + line.size.x, true);
+		} else {
+			visit(columns, line.pos.x, line.pos.y, line.pos.y + line.size.y, false);
+		}
+	}
+
+private:
+	static void insert(std::vector<int32_t> &track, int32_t value) {
+		const auto it = std::ranges::lower_bound(track, value);
+		if (it == track.end() || *it != value) track.insert(it, value);
+	}
+
+	static void erase(std::unordered_map<int32_t, std::vector<int32_t>> &tracks, int32_t key, int32_t value) {
+		const auto it = tracks.find(key);
+		if (it == tracks.end()) return;
+		auto &track = it->second;
+		if (const auto valueIt = std::ranges::lower_bound(track, value); valueIt != track.end() && *valueIt == value) track.erase(valueIt);
+		if (track.empty()) tracks.erase(it);
+	}
+};
\ No newline at end of file
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Eigen/Sparse"
+#include "graphDescriptor.hpp"
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+// Fundamental loops and cutsets of a netlist, from a breadth first spanning tree of its nodes
+// Nothing in the nodal simulations needs them, so they are only built when a loop based analysis or report asks for them
+// Every element is a branch oriented from its first pin to its second, the sign says if a loop or cutset goes along it
+struct LoopAnalysis {
+	struct Entry {
+		// Index of the element in the graph
+		uint32_t element;
+		int32_t sign;
+	};
+
+	// Elements in the spanning tree, one per node that isn't the root of a tree
+	std::vector<uint32_t> treeBranches{};
+	// Elements that close a loop, one loop each
+	std::vector<uint32_t> chords{};
+
+	explicit LoopAnalysis(const GraphDescriptor &graph);
+
+	// Loop closed by chords[index], it starts with the chord and then follows the tree back to where the chord started
+	[[nodiscard]] std::span<const Entry> loop(size_t index) const {
+		return std::span(loopEntries).subspan(loopOffsets[index], loopOffsets[index + 1] - loopOffsets[index]);
+	}
+	// Cutset of treeBranches[index], the branch first and then the chords whose loops go through it
+	[[nodiscard]] std::span<const Entry> cutset(size_t index) const {
+		return std::span(cutsetEntries).subspan(cutsetOffsets[index], cutsetOffsets[index + 1] - cutsetOffsets[index]);
+	}
+
+	// Fundamental loop matrix B, a row per chord and a column per element of the graph
+	[[nodiscard]] Eigen::SparseMatrix<float> loopMatrix() const;
+	// Fundamental cutset matrix Q, a row per tree branch and a column per element of the graph
+	[[nodiscard]] Eigen::SparseMatrix<float> cutsetMatrix() const;
+
+private:
+	size_t elementCount = 0;
+	std::vector<uint32_t> loopOffsets{0};
+	std::vector<Entry> loopEntries{};
+	std::vector<uint32_t> cutsetOffsets{0};
+	std::vector<Entry> cutsetEntries{};
+
+	[[nodiscard]] Eigen::SparseMatrix<float> matrix(size_t rows, const std::vector<uint32_t> &offsets, const std::vector<Entry> &entries) const;
+};
\ No newline at end of file
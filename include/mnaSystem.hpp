@@ -0,0 +1,449 @@
+#pragma once
+
+#include "Eigen/Dense"
+#include "Eigen/Sparse"
+#include "element.hpp"
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <optional>
+#include <print>
+#include <span>
+#include <vector>
+
+struct GraphDescriptor;
+
+struct MnaBranch {
+	enum class Type {
+		admittance,
+		voltageSource,
+		currentSource,
+		// Not stamped at all, a capacitor in the D.C. analysis
+		open,
+	};
+
+	Type type;
+	ElementId id;
+	// Graph node indices, node 0 is the reference (ground) node
+	uint32_t nodeA;
+	uint32_t nodeB;
+
+	bool operator==(const MnaBranch &other) const = default;
+};
+
+struct MnaTopology {
+	enum class Analysis {
+		general,
+		// Capacitors are left open and inductors become 0V sources, so nothing needs an extreme admittance
+		dc,
+	};
+
+	// Node count including the ground node
+	uint32_t nodeCount = 0;
+	// Inductors are counted too in the D.C. analysis
+	uint32_t voltageSourceCount = 0;
+	// One branch for every element of the graph, in the same order
+	std::vector<MnaBranch> branches{};
+	// One node of every part that has no D.C. path to ground, tied to ground with a 1S conductance so its voltages are defined
+	std::vector<uint32_t> referenceNodes{};
+	// One node of every part that has no D.C. path to ground but is fed by a current source, it has no D.C. solution
+	std::vector<uint32_t> floatingNodes{};
+	// Inductors across a voltage source or closing a loop of sources and inductors, left open so the system stays solvable
+	// An ideal inductor there has no defined D.C. current, so the D.C. run is refused
+	std::vector<ElementId> shortedInductors{};
+
+	MnaTopology() = default;
+	MnaTopology(const GraphDescriptor &graph, Analysis analysis = Analysis::general);
+
+	bool operator==(const MnaTopology &other) const = default;
+
+	// Unknowns are the node voltages (without ground) followed by the voltage source currents
+	[[nodiscard]] int64_t size() const {
+		return static_cast<int64_t>(nodeCount) - 1 + voltageSourceCount;
+	}
+
+	[[nodiscard]] size_t hash() const;
+};
+
+// How a reused system takes in new values
+enum class MnaRefactor {
+	// A low rank correction of the last factorization when only a few values changed
+	// The result depends on what the system solved before, which is fine for re-running an edited board
+	incremental,
+	// Always a new numeric factorization, so batch runs get the same results whatever order their points are solved in
+	always,
+};
+
+// Keeps the columns in the order they come in, unlike Eigen::NaturalOrdering the solver still postorders the elimination tree
+struct IdentityOrdering {
+	using PermutationType = Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int>;
+
+	template<class MatrixType>
+	void operator()(const MatrixType &mat, PermutationType &perm) {
+		perm.setIdentity(mat.cols());
+	}
+};
+
+// Sparse modified nodal analysis system
+// The sparsity pattern, the fill reducing ordering and the symbolic factorization only depend on the topology
+// so they are computed once on construction. Changing the element values only needs refactor() + solve()
+// or update() + solve() when just a few elements changed
+template<class T>
+struct MnaSystem {
+	using Matrix = Eigen::SparseMatrix<T>;
+	using Vector = Eigen::Vector<T, Eigen::Dynamic>;
+	using DenseMatrix = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>;
+	// The columns are already permuted with the fill reducing ordering, so the solver keeps them in place
+	using Solver = Eigen::SparseLU<Matrix, IdentityOrdering>;
+
+	MnaSystem(MnaTopology topology) : pattern(std::make_shared<const Pattern>(std::move(topology))) {
+		matrix = Eigen::Map<const Eigen::SparseMatrix<float>>(
+					 pattern->size,
+					 pattern->size,
+					 static_cast<int64_t>(pattern->baseValues.size()),
+					 pattern->outerIndex.data(),
+					 pattern->innerIndex.data(),
+					 pattern->baseValues.data()
+		)
+					 .template cast<T>();
+		solver->analyzePattern(matrix);
+	}
+
+	// Copies share the pattern and the ordering, only the cheap elimination tree analysis is redone
+	// Useful for giving every worker thread its own numeric factorization
+	MnaSystem(const MnaSystem &other) : pattern(other.pattern), matrix(other.matrix), values(other.values) {
+		solver->analyzePattern(matrix);
+	}
+	MnaSystem(MnaSystem &&) = default;
+	MnaSystem &operator=(const MnaSystem &other) {
+		return *this = MnaSystem(other);
+	}
+	MnaSystem &operator=(MnaSystem &&) = default;
+	~MnaSystem() = default;
+
+	[[nodiscard]] const MnaTopology &topology() const {
+		return pattern->topology;
+	}
+
+	// Values are indexed the same as the topology branches
+	// admittance -> branch admittance, voltageSource -> source voltage, currentSource -> source current
+	// shunt is an extra admittance from every node to ground, used to help a nonlinear solve converge
+	bool refactor(std::span<const T> newValues, T shunt = T{}) {
+		values.assign(newValues.begin(), newValues.end());
+		factoredValues = values;
+		shunted = shunt != T{};
+		lowRankBranches.clear();
+		lowRankSolved.resize(0, 0);
+		cachedSolution.reset();
+
+		auto *matrixValues = matrix.valuePtr();
+		std::ranges::copy(pattern->baseValues, matrixValues);
+		if (shunt != T{}) {
+			for (const auto &position: pattern->diagonalPositions) {
+				matrixValues[position] += shunt;
+			}
+		}
+		for (size_t i = 0; i < values.size(); i++) {
+			if (pattern->topology.branches.at(i).type != MnaBranch::Type::admittance) continue;
+			const auto &positions = pattern->stampPositions.at(i);
+			const auto value = values.at(i);
+			if (positions.aa != -1) matrixValues[positions.aa] += value;
+			if (positions.bb != -1) matrixValues[positions.bb] += value;
+			if (positions.ab != -1) matrixValues[positions.ab] -= value;
+			if (positions.ba != -1) matrixValues[positions.ba] -= value;
+		}
+
+		solver->factorize(matrix);
+		factorized = solver->info() == Eigen::Success;
+		if (!factorized) {
+			std::println("Failed to factorize the circuit matrix: {}", solver->lastErrorMessage());
+		}
+		return factorized;
+	}
+
+	// Same as refactor(), but when only a few admittances differ from the last factorization the difference is applied
+	// as a low rank (Woodbury) correction to it. Every admittance that changed since then costs one extra solve
+	// Falls back to refactor() once too many changes pile up or the corrected solution isn't accurate enough
+	bool update(std::span<const T> newValues) {
+		if (!factorized || shunted || newValues.size() != factoredValues.size()) return refactor(newValues);
+		values.assign(newValues.begin(), newValues.end());
+		cachedSolution.reset();
+
+		std::vector<size_t> changed{};
+		for (size_t i = 0; i < values.size(); i++) {
+			if (pattern->topology.branches.at(i).type != MnaBranch::Type::admittance) continue;
+			if (values.at(i) != factoredValues.at(i)) changed.emplace_back(i);
+		}
+		if (changed.size() > maxLowRankUpdates) return refactor(newValues);
+
+		// A^-1 u for the incidence vector u of every changed branch, reused from the last update when the branch was already in it
+		const auto rank = static_cast<int64_t>(changed.size());
+		DenseMatrix solved(pattern->size, rank);
+		for (int64_t column = 0; column < rank; column++) {
+			const auto branch = changed.at(column);
+			const auto previous = std::ranges::find(lowRankBranches, branch);
+			if (previous != lowRankBranches.end()) {
+				solved.col(column) = lowRankSolved.col(std::distance(lowRankBranches.begin(), previous));
+				continue;
+			}
+			Vector incidence = Vector::Zero(pattern->size);
+			const auto &mnaBranch = pattern->topology.branches.at(branch);
+			if (mnaBranch.nodeA != 0) incidence(mnaBranch.nodeA - 1) = T{1};
+			if (mnaBranch.nodeB != 0) incidence(mnaBranch.nodeB - 1) = T{-1};
+			const auto incidenceSolution = solveFactorized(incidence);
+			if (!incidenceSolution.has_value()) return refactor(newValues);
+			solved.col(column) = *incidenceSolution;
+		}
+
+		// Capacitance matrix C^-1 + U^T A^-1 U, where C holds the admittance changes
+		DenseMatrix capacitance(rank, rank);
+		for (int64_t row = 0; row < rank; row++) {
+			for (int64_t column = 0; column < rank; column++) {
+				capacitance(row, column) = incidenceDot(changed.at(row), solved.col(column));
+			}
+			capacitance(row, row) += T{1} / (values.at(changed.at(row)) - factoredValues.at(changed.at(row)));
+		}
+		lowRankBranches = std::move(changed);
+		lowRankSolved = std::move(solved);
+		if (rank > 0) {
+			lowRankLu.compute(capacitance);
+			if (!(lowRankLu.rcond() >= accuracyThreshold())) return refactor(newValues);
+		}
+
+		// The correction loses precision as it grows, check it against the sources this system will most likely be solved for
+		const auto rhs = sourceVector();
+		auto solution = solve(rhs);
+		if (!solution.has_value() || !(relativeResidual(*solution, rhs) <= accuracyThreshold())) return refactor(newValues);
+		cachedSolution = std::move(solution);
+		return true;
+	}
+
+	// refactor() or update(), depending on refactor
+	bool factorize(std::span<const T> newValues, MnaRefactor refactor) {
+		return refactor == MnaRefactor::always ? this->refactor(newValues) : update(newValues);
+	}
+
+	// Right hand side produced by the sources of the last refactor() or update() call
+	[[nodiscard]] Vector sourceVector() const {
+		return sourceVector(values);
+	}
+
+	// Right hand side produced by the sources in values, the admittance values are ignored
+	[[nodiscard]] Vector sourceVector(std::span<const T> branchValues) const {
+		Vector rhs = Vector::Zero(pattern->size);
+		int64_t sourceRow = static_cast<int64_t>(pattern->topology.nodeCount) - 1;
+		for (size_t i = 0; i < branchValues.size(); i++) {
+			const auto &branch = pattern->topology.branches.at(i);
+			const auto value = branchValues[i];
+			switch (branch.type) {
+				case MnaBranch::Type::admittance:
+				case MnaBranch::Type::open:
+					break;
+				case MnaBranch::Type::voltageSource:
+					rhs(sourceRow++) = -value;
+					break;
+				case MnaBranch::Type::currentSource:
+					if (branch.nodeA != 0) rhs(branch.nodeA - 1) -= value;
+					if (branch.nodeB != 0) rhs(branch.nodeB - 1) += value;
+					break;
+			}
+		}
+		return rhs;
+	}
+
+	[[nodiscard]] std::optional<Vector> solve() const {
+		if (cachedSolution.has_value()) return cachedSolution;
+		return solve(sourceVector());
+	}
+
+	[[nodiscard]] std::optional<Vector> solve(const Vector &rhs) const {
+		auto solution = solveFactorized(rhs);
+		if (!solution.has_value() || lowRankBranches.empty()) return solution;
+		// Woodbury: x = y - A^-1 U (C^-1 + U^T A^-1 U)^-1 U^T y, with y = A^-1 b
+		Vector projected(static_cast<int64_t>(lowRankBranches.size()));
+		for (int64_t i = 0; i < projected.size(); i++) {
+			projected(i) = incidenceDot(lowRankBranches.at(i), *solution);
+		}
+		*solution -= lowRankSolved * lowRankLu.solve(projected);
+		return solution;
+	}
+
+	// Number of admittances applied as a low rank correction instead of being factorized
+	[[nodiscard]] size_t pendingUpdates() const {
+		return lowRankBranches.size();
+	}
+
+private:
+	// Past this many changed admittances a new factorization is cheaper than the correction
+	static constexpr size_t maxLowRankUpdates = 32;
+
+	[[nodiscard]] static auto accuracyThreshold() {
+		return std::sqrt(std::numeric_limits<typename Eigen::NumTraits<T>::Real>::epsilon());
+	}
+
+	// u^T vec for the incidence vector u of the branch
+	[[nodiscard]] T incidenceDot(size_t branchIndex, const auto &vec) const {
+		const auto &branch = pattern->topology.branches.at(branchIndex);
+		T ret{};
+		if (branch.nodeA != 0) ret += vec(branch.nodeA - 1);
+		if (branch.nodeB != 0) ret -= vec(branch.nodeB - 1);
+		return ret;
+	}
+
+	// |A x - b| / (|A x| + |b|) for the current values, including the low rank changes
+	[[nodiscard]] auto relativeResidual(const Vector &solution, const Vector &rhs) const {
+		Vector product = matrix * (pattern->ordering * solution);
+		for (const auto &branch: lowRankBranches) {
+			const auto &mnaBranch = pattern->topology.branches.at(branch);
+			const auto current = (values.at(branch) - factoredValues.at(branch)) * incidenceDot(branch, solution);
+			if (mnaBranch.nodeA != 0) product(mnaBranch.nodeA - 1) += current;
+			if (mnaBranch.nodeB != 0) product(mnaBranch.nodeB - 1) -= current;
+		}
+		const auto scale = product.norm() + rhs.norm();
+		return scale == 0 ? scale : (product - rhs).norm() / scale;
+	}
+
+	// Solution with the factorized matrix only, without the low rank correction
+	[[nodiscard]] std::optional<Vector> solveFactorized(const Vector &rhs) const {
+		if (!factorized) return std::nullopt;
+		Vector permuted = solver->solve(rhs);
+		if (solver->info() != Eigen::Success) {
+			std::println("Failed to solve the circuit matrix");
+			return std::nullopt;
+		}
+		return pattern->ordering.inverse() * permuted;
+	}
+
+	struct StampPositions {
+		int64_t aa = -1;
+		int64_t bb = -1;
+		int64_t ab = -1;
+		int64_t ba = -1;
+	};
+
+	// Everything that only depends on the topology
+	struct Pattern {
+		MnaTopology topology;
+		int64_t size = topology.size();
+		Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, int> ordering{};
+		std::vector<int> outerIndex{};
+		std::vector<int> innerIndex{};
+		// Constant part of the matrix (the voltage source incidence and the reference nodes), every admittance stamp starts at 0
+		std::vector<float> baseValues{};
+		std::vector<StampPositions> stampPositions{};
+		std::vector<int64_t> diagonalPositions{};
+
+		Pattern(MnaTopology &&topo) : topology(std::move(topo)) {
+			std::vector<Eigen::Triplet<float>> triplets{};
+			triplets.reserve(topology.nodeCount + topology.branches.size() * 4);
+			// Keep every node diagonal in the pattern even when nothing is stamped there yet
+			for (int i = 0; i < static_cast<int>(topology.nodeCount) - 1; i++) {
+				triplets.emplace_back(i, i, 0.f);
+			}
+			forEachStamp([&](int row, int col, float value) {
+				triplets.emplace_back(row, col, value);
+			});
+
+			Eigen::SparseMatrix<float> unordered(size, size);
+			unordered.setFromTriplets(triplets.begin(), triplets.end());
+			unordered.makeCompressed();
+			Eigen::COLAMDOrdering<int>{}(unordered, ordering);
+
+			for (auto &triplet: triplets) {
+				triplet = Eigen::Triplet<float>(triplet.row(), ordering.indices()(triplet.col()), triplet.value());
+			}
+			Eigen::SparseMatrix<float> ordered(size, size);
+			ordered.setFromTriplets(triplets.begin(), triplets.end());
+			ordered.makeCompressed();
+
+			outerIndex.assign(ordered.outerIndexPtr(), ordered.outerIndexPtr() + ordered.outerSize() + 1);
+			innerIndex.assign(ordered.innerIndexPtr(), ordered.innerIndexPtr() + ordered.nonZeros());
+			baseValues.assign(ordered.valuePtr(), ordered.valuePtr() + ordered.nonZeros());
+
+			diagonalPositions.reserve(topology.nodeCount);
+			for (int i = 0; i < static_cast<int>(topology.nodeCount) - 1; i++) {
+				diagonalPositions.emplace_back(position(i, i));
+			}
+
+			stampPositions.reserve(topology.branches.size());
+			for (const auto &branch: topology.branches) {
+				auto &positions = stampPositions.emplace_back();
+				if (branch.type != MnaBranch::Type::admittance) continue;
+				const bool hasA = branch.nodeA != 0;
+				const bool hasB = branch.nodeB != 0;
+				const auto a = static_cast<int>(branch.nodeA) - 1;
+				const auto b = static_cast<int>(branch.nodeB) - 1;
+				if (hasA) positions.aa = position(a, a);
+				if (hasB) positions.bb = position(b, b);
+				if (hasA && hasB) {
+					positions.ab = position(a, b);
+					positions.ba = position(b, a);
+				}
+			}
+		}
+
+		// Calls func for every constant entry and marks the place of every admittance entry with a 0
+		void forEachStamp(auto &&func) const {
+			for (const auto &node: topology.referenceNodes) {
+				const auto index = static_cast<int>(node) - 1;
+				func(index, index, 1.f);
+			}
+			int sourceRow = static_cast<int>(topology.nodeCount) - 1;
+			for (const auto &branch: topology.branches) {
+				const bool hasA = branch.nodeA != 0;
+				const bool hasB = branch.nodeB != 0;
+				const auto a = static_cast<int>(branch.nodeA) - 1;
+				const auto b = static_cast<int>(branch.nodeB) - 1;
+				switch (branch.type) {
+					case MnaBranch::Type::admittance: {
+						if (hasA && hasB) {
+							func(a, b, 0.f);
+							func(b, a, 0.f);
+						}
+						break;
+					}
+					case MnaBranch::Type::voltageSource: {
+						const auto row = sourceRow++;
+						if (hasA) {
+							func(a, row, 1.f);
+							func(row, a, 1.f);
+						}
+						if (hasB) {
+							func(b, row, -1.f);
+							func(row, b, -1.f);
+						}
+						break;
+					}
+					case MnaBranch::Type::currentSource:
+					case MnaBranch::Type::open:
+						break;
+				}
+			}
+		}
+
+		// Index in the compressed value array of the entry at (row, col) of the unordered matrix
+		[[nodiscard]] int64_t position(int row, int col) const {
+			const auto orderedCol = ordering.indices()(col);
+			const auto begin = innerIndex.begin() + outerIndex.at(orderedCol);
+			const auto end = innerIndex.begin() + outerIndex.at(orderedCol + 1);
+			const auto it = std::lower_bound(begin, end, row);
+			assert(it != end && *it == row);
+			return std::distance(innerIndex.begin(), it);
+		}
+	};
+
+	std::shared_ptr<const Pattern> pattern;
+	Matrix matrix{};
+	std::unique_ptr<Solver> solver = std::make_unique<Solver>();
+	std::vector<T> values{};
+	bool factorized = false;
+	// Values the matrix was last factorized with
+	std::vector<T> factoredValues{};
+	bool shunted = false;
+	// Admittances changed by update() since the last factorization, with A^-1 u for each of them
+	std::vector<size_t> lowRankBranches{};
+	DenseMatrix lowRankSolved{};
+	Eigen::PartialPivLU<DenseMatrix> lowRankLu{};
+	// Solution for the sources, computed by update() while checking the accuracy of the correction
+	std::optional<Vector> cachedSolution{};
+};
\ No newline at end of file
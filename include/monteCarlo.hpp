@@ -0,0 +1,83 @@
+#pragma once
+#include "graphDescriptor.hpp"
+#include "mnaSystem.hpp"
+#include "simulationProgress.hpp"
+#include <complex>
+
+// Repeats a D.C. or A.C. solve with every NumberProperty that has a tolerance randomized inside it
+// The results are reduced while the trials run, so the memory use doesn't grow with the trial count
+struct MonteCarlo {
+	enum class Analysis {
+		dc,
+		// Magnitudes of the phasors at settings.frequency
+		ac,
+	};
+
+	struct Settings {
+		Analysis analysis = Analysis::dc;
+		uint32_t trials = 1000;
+		// Same seed and settings give the same results, no matter the thread count
+		uint64_t seed = 1;
+		float frequency = 50.f;
+		uint32_t histogramBins = 32;
+	};
+
+	// Running mean and variance (Welford), mergeable between partial results
+	struct Statistics {
+		uint64_t count = 0;
+		double mean = 0.0;
+		// Sum of the squared differences from the mean
+		double m2 = 0.0;
+		double min = std::numeric_limits<double>::infinity();
+		double max = -std::numeric_limits<double>::infinity();
+
+		void add(double value);
+		void merge(const Statistics &other);
+
+		[[nodiscard]] double variance() const {
+			return count > 1 ? m2 / static_cast<double>(count - 1) : 0.0;
+		}
+
+		[[nodiscard]] double standardDeviation() const {
+			return std::sqrt(variance());
+		}
+	};
+
+	// Fixed range histogram, values outside of the range are counted in the first and last bins
+	struct Histogram {
+		double low = 0.0;
+		double high = 0.0;
+		std::vector<uint32_t> bins{};
+
+		void add(double value);
+		void merge(const Histogram &other);
+
+		[[nodiscard]] double binCenter(size_t bin) const {
+			return low + (high - low) * (static_cast<double>(bin) + 0.5) / static_cast<double>(bins.size());
+		}
+	};
+
+	struct Summary {
+		Statistics statistics{};
+		Histogram histogram{};
+	};
+
+	struct CurrentSummary {
+		ElementId id;
+		Summary summary{};
+	};
+
+	Settings settings{};
+	// One per node, without the ground node
+	std::vector<Summary> voltages{};
+	// One per voltage source, followed by one per diode for D.C. runs
+	std::vector<CurrentSummary> currents{};
+	// Number of properties that had a tolerance
+	size_t randomizedProperties = 0;
+	uint32_t failedTrials = 0;
+
+	MonteCarlo(const GraphDescriptor &, const Settings &);
+	// Reuses the symbolic analysis of the system used by the analysis if the topology is the same, replaces it otherwise
+	// progress is optional, it gets the done fraction of the trials and can cancel the run, leaving the results empty
+	MonteCarlo(const GraphDescriptor &, const Settings &, std::optional<MnaSystem<double>> &dcSystem, std::optional<MnaSystem<std::complex<float>>> &acSystem, SimulationProgress *progress = nullptr);
+};
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "coords.hpp"
+#include "element.hpp"
+#include "gridIndex.hpp"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct BoardStorage;
+struct ThreadPool;
+
+using NetId = uint32_t;
+
+// Which connection points are joined together by lines and labels
+// BoardStorage keeps it up to date on every edit, so the nets are known at any time without walking the board
+// Placing things merges nets, removing a line or a label only re-explores the net it was part of
+struct NetIndex {
+	struct PointInfo {
+		NetId net;
+		// Position of the point in the points of its net
+		uint32_t index;
+	};
+	// Every connection point with something attached
+	std::unordered_map<Coords, PointInfo> pointNets{};
+	std::unordered_map<NetId, std::vector<Coords>> netPoints{};
+	// The same points by row and column, so the points along a line are found without going over its tiles
+	PointIndex gridPoints{};
+	// Pins of the labels with every name, with the number of labels on every point
+	// Grounds are labels too, so joining them doesn't need a scan of the board
+	std::unordered_map<std::string, std::unordered_map<Coords, uint32_t>> labelPoints{};
+	// Name of every label on the board, kept so a renamed label can leave its old net
+	std::unordered_map<ElementId, std::string> labelNames{};
+	// Edits are ignored until the next rebuild, used while loading a whole board
+	bool suspended = false;
+
+	[[nodiscard]] std::optional<NetId> netOf(const Coords &point) const;
+	[[nodiscard]] std::span<const Coords> pointsOf(NetId net) const;
+	// Name the element connects by, every ground is called GND
+	[[nodiscard]] static std::optional<std::string> labelOf(const Element &elem);
+
+	// Called by BoardStorage once the element or line is on the board
+	void elementPlaced(const BoardStorage &board, const Element &elem);
+	void linePlaced(const BoardStorage &board, const Element &elem);
+	// Called by BoardStorage once the connections of the element are gone
+	void elementRemoved(const BoardStorage &board, const Element &elem);
+	// Called by BoardStorage once the line is off the board
+	void lineRemoved(const BoardStorage &board, const Element &elem);
+	// Called by BoardStorage after the properties of the element were edited, a label might have a new name
+	void elementChanged(const BoardStorage &board, const Element &elem);
+
+	// Finds all the nets of the board from scratch
+	// With a pool the points are bucketed, labelled and given their nets region by region in parallel, the nets come out the same either way
+	void rebuild(const BoardStorage &board, ThreadPool *pool = nullptr);
+
+private:
+	NetId nextNet = 0;
+
+	// Returns the net of the point, a new point gets a net of its own
+	NetId addPoint(const Coords &point);
+	void removePoint(const Coords &point);
+	// Merges the net with the nets of the lines that pass over the point or end on it
+	NetId joinLinesAt(const BoardStorage &board, const Coords &point, NetId net);
+	// The points of the smaller net are moved to the larger one, returns the net that is left
+	NetId merge(NetId a, NetId b);
+	// Joins the point with the other labels of that name
+	NetId addLabel(const std::string &name, const Coords &point, NetId net);
+	// Returns the net of the point if it might have to be split now
+	std::optional<NetId> removeLabel(const std::string &name, const Coords &point);
+	// Gives new nets to the points of the given nets from the lines and labels that are still on the board
+	void split(const BoardStorage &board, std::vector<NetId> nets);
+};
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "graphDescriptor.hpp"
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <vector>
+
+
+// Builds a GraphDescriptor in code, without a board and without any tiles, connections or widgets
+// The simulations take the result like any other netlist
+// Nodes and elements can be added in any order, build() puts them in the order the simulations expect
+struct NetlistBuilder {
+	// Component ids of the elements the simulations know about
+	enum class Type : uint32_t {
+		voltageSource = 2,
+		currentSource = 3,
+		resistor = 4,
+		capacitor = 6,
+		inductor = 7,
+		diode = 8,
+	};
+
+	// Always there, the node voltages are relative to it
+	static constexpr uint32_t ground = 0;
+
+	// Returns the index of a new node
+	[[nodiscard]] uint32_t addNode();
+	[[nodiscard]] uint32_t nodeCount() const {
+		return nodes;
+	}
+
+	// The nodes are in the order of the component's pins:
+	// a voltage source has its positive side on the second node, a current source drives current from the first node to the second
+	// and a diode has its anode on the first node
+	// Values that aren't given get the defaults of the property set, sources are in A.C. mode with property set 1
+	// Returns the id of the element, ids are handed out in the order the elements are added
+	// A wrong pin count, property set, node or more values than the property set has is printed and the element isn't added
+	std::optional<ElementId> addElement(Type type, std::span<const uint32_t> pins, std::span<const float> values, uint32_t propertySetIndex = 0);
+	std::optional<ElementId> addElement(Type type, std::initializer_list<uint32_t> pins, std::initializer_list<float> values, uint32_t propertySetIndex = 0) {
+		return addElement(type, std::span(pins.begin(), pins.size()), std::span(values.begin(), values.size()), propertySetIndex);
+	}
+
+	// Elements with all their pins on the same node are left out, like on a board
+	// Nodes that no element is connected to are left out too and the others are renumbered in the same order
+	// The builder is left empty, only the node mapping of the build is kept for nodeIndex
+	[[nodiscard]] GraphDescriptor build();
+
+	// Index in the graph of the last build() of a node returned by addNode, std::nullopt if the node was left out
+	[[nodiscard]] std::optional<uint32_t> nodeIndex(uint32_t node) const;
+
+private:
+	struct Entry {
+		uint32_t componentId;
+		uint32_t propertySetIndex;
+	};
+
+	uint32_t nodes = 1;
+	// Element i has the id i + 1, its pins start at pinOffsets[i] and its values at valueOffsets[i]
+	std::vector<Entry> entries{};
+	std::vector<uint32_t> pinOffsets{0};
+	std::vector<uint32_t> pinNodes{};
+	std::vector<uint32_t> valueOffsets{0};
+	std::vector<float> values{};
+	// Node index of every builder node in the last built graph, unused for the nodes that were left out
+	std::vector<uint32_t> builtNodeIds{};
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+#include "dcSimulation.hpp"
+#include "graphDescriptor.hpp"
+#include "mnaSystem.hpp"
+#include "simulationProgress.hpp"
+#include <span>
+
+// D.C. operating point of every combination of a set of property values
+// The topology doesn't change between points, so every point reuses the same ordering and symbolic analysis
+struct ParametricSweep {
+	struct Parameter {
+		ElementId id;
+		// Index of the property in the active property set of the element
+		size_t propertyIndex = 0;
+		std::vector<float> values{};
+	};
+
+	std::vector<Parameter> parameters{};
+	// Product of the value counts of every parameter, the first parameter changes the fastest
+	size_t pointCount = 0;
+	// Node count without the ground node
+	size_t nodeCount = 0;
+	// Elements the currents belong to, in the same order as DCSimulation::currents
+	std::vector<ElementId> currentIds{};
+	// Point major, nodeCount voltages and currentIds.size() currents for every point, NaN for points that didn't converge
+	std::vector<float> voltages{};
+	std::vector<float> currents{};
+	size_t failedPoints = 0;
+
+	ParametricSweep(const GraphDescriptor &, std::vector<Parameter> parameters);
+	// Reuses the symbolic analysis of system if the topology is the same, replaces it otherwise
+	// progress is optional, it gets the done fraction of the points and can cancel the sweep, leaving the results empty
+	ParametricSweep(const GraphDescriptor &, std::vector<Parameter> parameters, std::optional<MnaSystem<double>> &system, SimulationProgress *progress = nullptr);
+
+	[[nodiscard]] float parameterValue(size_t point, size_t parameter) const;
+
+	[[nodiscard]] std::span<const float> pointVoltages(size_t point) const {
+		return std::span(voltages).subspan(point * nodeCount, nodeCount);
+	}
+
+	[[nodiscard]] std::span<const float> pointCurrents(size_t point) const {
+		return std::span(currents).subspan(point * currentIds.size(), currentIds.size());
+	}
+};
\ No newline at end of file
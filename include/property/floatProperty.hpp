@@ -1,36 +1,29 @@
 #pragma once
 #include "../elementProperty.hpp"
-#include "observer.hpp"
-#include "widget.hpp"
+#include <cstdint>
 #include <span>
+#include <string>
+#include <vector>
 
 struct NumberProperty {
+	// How a Monte Carlo run spreads the value inside the tolerance
+	enum class Distribution : uint32_t {
+		uniform,
+		// The tolerance is 3 standard deviations
+		gaussian,
+	};
+
 	std::string name{};
 	std::string suffix{};
 	mutable float value;
+	// In percent of the value, 0 keeps the value fixed in Monte Carlo runs
+	mutable float tolerance = 0.f;
+	mutable Distribution distribution = Distribution::uniform;
 
 	[[nodiscard]] static NumberProperty fromData(const PropertyData &data);
-	[[nodiscard]] squi::Child createInput(const squi::VoidObservable &closeObs, const squi::Observable<bool> &focusObs) const;
 
 	[[nodiscard]] std::vector<std::byte> serialize() const;
 	[[nodiscard]] static NumberProperty deserialize(const std::span<const std::byte> &bytes, const PropertyData &data);
 
 	[[nodiscard]] std::string display() const;
-
-	struct Input {
-		// Args
-		// squi::Widget::Args widget{};
-		squi::VoidObservable closeObs{};
-		squi::Observable<bool> focusObs{};
-		std::string_view name;
-		float &value;
-
-		struct Storage {
-			// Data
-			float newValue;
-			float &value;
-		};
-
-		operator squi::Child() const;
-	};
 };
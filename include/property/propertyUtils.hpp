@@ -3,9 +3,11 @@
 #include "../component.hpp"
 #include "../utils.hpp"
 #include "floatProperty.hpp"
+#include "textProperty.hpp"
+#include <format>
 
 
-using PropertiesTypes = std::tuple<NumberProperty>;
+using PropertiesTypes = std::tuple<NumberProperty, TextProperty>;
 using PropertyVariant = Utils::TransferParams<std::variant, PropertiesTypes>::type;
 
 template<class T>
@@ -14,7 +16,6 @@ using CleanedType = std::remove_const_t<std::remove_reference_t<T>>;
 template<class T>
 concept PropertyLike = requires(T a) {
 	{ CleanedType<T>::fromData(std::declval<const PropertyData &>()) } -> std::same_as<CleanedType<T>>;
-	{ a.createInput(squi::VoidObservable{}, squi::Observable<bool>{}) } -> std::same_as<squi::Child>;
 	{ a.serialize() } -> std::same_as<std::vector<std::byte>>;
 	{ CleanedType<T>::deserialize(std::declval<std::span<const std::byte>>(), std::declval<const PropertyData &>()) }
 	  -> std::same_as<CleanedType<T>>;
@@ -62,11 +63,22 @@ static inline std::vector<PropertyVariant> getProperties(size_t index, const Com
 static inline float getFloat(const PropertyVariant &property) {
 	return std::visit(
 		[](auto &&prop) {
-			if (std::is_same_v<NumberProperty, std::decay_t<decltype(prop)>>) {
+			if constexpr (std::is_same_v<NumberProperty, std::decay_t<decltype(prop)>>) {
 				return prop.value;
 			}
 			return 0.f;
 		},
 		property
 	);
+}
+
+// Turns a saved property into the type data asks for, when a component changed the type of one of its properties
+static inline PropertyVariant convertProperty(PropertyVariant &&property, const PropertyData &data) {
+	if (static_cast<PropertyIndex>(property.index()) == data.type) return std::move(property);
+	auto ret = createProperty(data);
+	// Net labels used to be numbered, the number becomes the name they had
+	if (auto *text = std::get_if<TextProperty>(&ret)) {
+		if (const auto *number = std::get_if<NumberProperty>(&property)) text->value = std::format("Net {}", number->value);
+	}
+	return ret;
 }
\ No newline at end of file
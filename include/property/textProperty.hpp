@@ -0,0 +1,19 @@
+#pragma once
+#include "../elementProperty.hpp"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Free text, like the name of a net label
+struct TextProperty {
+	std::string name{};
+	mutable std::string value;
+
+	[[nodiscard]] static TextProperty fromData(const PropertyData &data);
+
+	[[nodiscard]] std::vector<std::byte> serialize() const;
+	[[nodiscard]] static TextProperty deserialize(const std::span<const std::byte> &bytes, const PropertyData &data);
+
+	[[nodiscard]] std::string display() const;
+};
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+#include "acSimulation.hpp"
+#include "dcSimulation.hpp"
+#include "graphDescriptor.hpp"
+#include <functional>
+#include <list>
+#include <variant>
+
+// Netlist that doesn't depend on the element ids, the node numbering or where things are on the board
+// The elements are ordered by a colour refined from their neighbourhood for a few rounds (Weisfeiler-Lehman), so the hash is the
+// same for any two equivalent circuits. Two netlists with equal records describe the same circuit, element for element
+struct CanonicalNetlist {
+	struct Record {
+		uint32_t componentId;
+		uint32_t propertySetIndex;
+		std::vector<GraphDescriptor::Value> properties;
+		// Canonical node of every pin
+		std::vector<uint32_t> nodes;
+
+		bool operator==(const Record &other) const = default;
+	};
+
+	uint32_t nodeCount = 0;
+	std::vector<Record> records{};
+	// Canonical element index -> id of the element in the graph
+	std::vector<ElementId> elementIds{};
+	// Canonical node index -> node index in the graph
+	std::vector<uint32_t> nodeIndices{};
+	size_t hash = 0;
+
+	CanonicalNetlist(const GraphDescriptor &graph);
+
+	bool operator==(const CanonicalNetlist &other) const {
+		return hash == other.hash && nodeCount == other.nodeCount && records == other.records;
+	}
+};
+
+// Least recently used cache of finished simulations, keyed by the canonical netlist and the analysis settings
+// Results of an equivalent netlist are translated to the element ids and node indices of the requested graph
+struct ResultCache {
+	size_t capacity = 16;
+	uint64_t hits = 0;
+	uint64_t misses = 0;
+
+	DCSimulation dc(const GraphDescriptor &graph, const std::function<DCSimulation()> &simulate);
+	ACSimulation ac(const GraphDescriptor &graph, float frequency, const std::function<ACSimulation()> &simulate);
+
+	void clear();
+
+private:
+	struct Entry {
+		CanonicalNetlist netlist;
+		// Hash of the analysis settings, every setting fits in it exactly
+		uint64_t settings;
+		std::variant<DCSimulation, ACSimulation> simulation;
+	};
+	// Most recently used first
+	std::list<Entry> entries{};
+
+	template<class T>
+	T get(const GraphDescriptor &graph, uint64_t settings, const std::function<T()> &simulate);
+};
\ No newline at end of file
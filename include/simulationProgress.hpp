@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stop_token>
+
+// Shared between a simulation running on a background thread and the UI waiting for it
+struct SimulationProgress {
+	enum class Stage : uint32_t {
+		// Building the GraphDescriptor from the board
+		extraction,
+		// Building the MNA topology and its symbolic analysis
+		assembly,
+		factorization,
+		solve,
+		done,
+	};
+
+	std::atomic<Stage> stage = Stage::extraction;
+	// Done part of a simulation made of many points, steps or trials, from 0 to 1
+	// Negative for the simulations that are a single solve
+	std::atomic<float> fraction = -1.f;
+	// Requested by the UI, the simulation checks it between stages and stops early
+	std::stop_token stopToken{};
+	// Called on the simulating thread every time a stage starts, lets the benchmarks time the stages separately
+	std::function<void(Stage)> onStage{};
+
+	[[nodiscard]] bool cancelled() const {
+		return stopToken.stop_requested();
+	}
+
+	// Sets the stage, returns false if the simulation should stop instead
+	static bool report(SimulationProgress *progress, Stage stage) {
+		if (!progress) return true;
+		progress->stage = stage;
+		if (progress->onStage) progress->onStage(stage);
+		return !progress->cancelled();
+	}
+
+	// Sets the done fraction, returns false if the simulation should stop instead
+	// Safe to call from the worker threads, unlike report() it doesn't call onStage
+	static bool advance(SimulationProgress *progress, float fraction) {
+		if (!progress) return true;
+		progress->fraction = fraction;
+		return !progress->cancelled();
+	}
+
+	[[nodiscard]] static bool cancelled(const SimulationProgress *progress) {
+		return progress && progress->cancelled();
+	}
+};
\ No newline at end of file
@@ -3,4 +3,7 @@
 enum class SimulationType {
     dcSim,
     acSim,
+    acSweep,
+    transientSim,
+    monteCarlo,
 };
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "graphDescriptor.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+
+// SPICE decks with R, C, L, V, I and D cards, read straight into a GraphDescriptor without placing anything on a board
+// Nodes named 0 or GND are the ground, the others are numbered in the order they first show up
+// A node with only shorted elements on it is left out and the nodes after it move down by one
+// Elements get their ids in the order of their cards, the exporter names them by their prefix and id
+struct SpiceNetlist {
+	// Parses the deck in a single pass, the errors are printed with their line number
+	[[nodiscard]] static std::optional<GraphDescriptor> parse(std::string_view deck);
+	// Maps the file into memory and parses it in place
+	[[nodiscard]] static std::optional<GraphDescriptor> read(const std::filesystem::path &path);
+
+	static void write(std::FILE *out, const GraphDescriptor &graph);
+	// Returns false if the file couldn't be written
+	static bool write(const std::filesystem::path &path, const GraphDescriptor &graph);
+};
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads that split index ranges between them
+// Every worker starts with an even slice of the range and steals half of the remaining work of another worker once it runs out
+struct ThreadPool {
+	explicit ThreadPool(size_t threadCount = std::max(1u, std::thread::hardware_concurrency()));
+	~ThreadPool();
+	ThreadPool(const ThreadPool &) = delete;
+	ThreadPool(ThreadPool &&) = delete;
+	ThreadPool &operator=(const ThreadPool &) = delete;
+	ThreadPool &operator=(ThreadPool &&) = delete;
+
+	// Pool shared by all the simulations, created on first use
+	static ThreadPool &shared();
+
+	[[nodiscard]] size_t size() const {
+		return threads.size();
+	}
+
+	// Calls func(workerIndex, index) for every index in [0, count) and blocks until all of them are done
+	// workerIndex is in [0, size()), so it can be used to pick per thread state without locking
+	// If func throws, the indices that haven't started yet are skipped and the first exception is rethrown here
+	// Called from inside func it runs every index inline on the calling worker, with that worker's index
+	void parallelFor(size_t count, const std::function<void(size_t workerIndex, size_t index)> &func);
+
+	// Successful steals since the pool was created, useful to see how uneven a workload is
+	[[nodiscard]] uint64_t stealCount() const {
+		return steals.load(std::memory_order_relaxed);
+	}
+
+private:
+	// Indices [begin, end) still owned by a worker, the owner takes from the front and thieves take from the back
+	struct alignas(64) WorkRange {
+		std::mutex mutex{};
+		size_t begin = 0;
+		size_t end = 0;
+	};
+
+	struct Job {
+		const std::function<void(size_t, size_t)> *func = nullptr;
+		size_t count = 0;
+		size_t chunkSize = 1;
+		size_t activeWorkers = 0;
+		// First exception thrown by func
+		std::exception_ptr exception{};
+	};
+
+	std::vector<std::thread> threads{};
+	std::unique_ptr<WorkRange[]> ranges{};
+	std::mutex mutex{};
+	std::condition_variable jobAvailable{};
+	std::condition_variable jobFinished{};
+	// Only one parallelFor can run at a time
+	std::mutex submitMutex{};
+	Job job{};
+	uint64_t generation = 0;
+	bool stopping = false;
+	std::atomic<uint64_t> steals = 0;
+	// Set once func threw, the workers stop taking new indices
+	std::atomic<bool> aborted = false;
+
+	void workerLoop(size_t workerIndex);
+	// Takes the next chunk of the worker's own range, returns an empty range once it is exhausted
+	std::pair<size_t, size_t> takeOwn(size_t workerIndex);
+	// Moves the back half of the fullest other range into the worker's range, false if there was nothing left
+	bool steal(size_t workerIndex);
+};
\ No newline at end of file
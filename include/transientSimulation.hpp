@@ -0,0 +1,54 @@
+#pragma once
+#include "graphDescriptor.hpp"
+#include "mnaSystem.hpp"
+#include "simulationProgress.hpp"
+
+// Time domain simulation, capacitors and inductors are replaced by their companion models at every step
+// Starts from zero initial conditions (discharged capacitors and no inductor current)
+// Diodes aren't supported yet, circuits with diodes are refused and leave the results empty
+// Solved in double, only the stored traces are converted to float
+struct TransientSimulation {
+	enum class Method {
+		backwardEuler,
+		trapezoidal,
+	};
+
+	struct Settings {
+		Method method = Method::trapezoidal;
+		float stopTime = 0.1f;
+		float timeStep = 1e-5f;
+		// Frequency of the sources set to A.C. mode
+		float sourceFrequency = 50.f;
+		// Only every outputStride-th step is stored, the last step is always stored
+		uint32_t outputStride = 10;
+
+		// Adaptive mode picks the step from the local truncation error of the capacitor voltages and inductor currents
+		// timeStep is then only the first step
+		bool adaptive = false;
+		float relTol = 1e-3f;
+		// In volts for the capacitors and in amperes for the inductors
+		float absTol = 1e-6f;
+		float minTimeStep = 1e-12f;
+		float maxTimeStep = 1e-3f;
+	};
+
+	struct CurrentTrace {
+		ElementId id;
+		std::vector<float> values{};
+	};
+
+	Settings settings{};
+	std::vector<float> times{};
+	// One trace per node, without the ground node
+	std::vector<std::vector<float>> voltages{};
+	// One trace per voltage source
+	std::vector<CurrentTrace> currents{};
+	uint64_t acceptedStepCount = 0;
+	uint64_t rejectedStepCount = 0;
+	uint64_t factorizationCount = 0;
+
+	TransientSimulation(const GraphDescriptor &, const Settings &);
+	// Reuses the symbolic analysis of system if the topology is the same, replaces it otherwise
+	// progress is optional, it gets the simulated fraction of the stop time and can cancel the simulation, leaving the results empty
+	TransientSimulation(const GraphDescriptor &, const Settings &, std::optional<MnaSystem<double>> &system, SimulationProgress *progress = nullptr);
+};
\ No newline at end of file
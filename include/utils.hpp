@@ -4,22 +4,12 @@
 #include "array"
 #include "component.hpp"
 #include "coords.hpp"
-#include "vec2.hpp"
 #include <variant>
 
 namespace Utils {
-	Coords screenToGridRounded(const squi::vec2 &screen, const squi::vec2 &offset, const squi::vec2 &boardPos);
-	Coords screenToGridFloored(const squi::vec2 &screen, const squi::vec2 &offset, const squi::vec2 &boardPos);
 	Coords componentSizeWithRotation(const Component &component, uint32_t rotation);
-	struct RotatedElementData {
-		squi::vec2 newTopLeft{};
-		squi::vec2 newTopRight{};
-		squi::vec2 newBottomRight{};
-		squi::vec2 newBottomLeft{};
-		std::vector<Coords> newNodes{};
-	};
-	RotatedElementData rotateElement(uint32_t rotation, const Component &comp);
-	std::tuple<Eigen::MatrixXf, std::vector<int64_t>> calculateNonzeroPivots(Eigen::MatrixXf &input);
+	// Node positions of the component after rotating it by rotation quarter turns
+	std::vector<Coords> rotateNodes(uint32_t rotation, const Component &comp);
 
 	template<class T, class TupleType, size_t... I>
 	int64_t consteval impl_getIndexFromTuple(std::index_sequence<I...> /*Indexes*/) {
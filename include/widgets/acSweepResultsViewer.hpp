@@ -0,0 +1,19 @@
+#pragma once
+#include "acSweep.hpp"
+#include "observer.hpp"
+#include "widget.hpp"
+
+struct ACSweepResultsViewer {
+	// Args
+	squi::Widget::Args widget{};
+	const GraphDescriptor &graph;
+	const BoardStorage &board;
+	const ACSweep &simulation;
+	squi::Observable<const std::vector<ElementId> &> elementSelector{};
+
+	struct Storage {
+		// Data
+	};
+
+	operator squi::Child() const;
+};
\ No newline at end of file
@@ -1,16 +1,26 @@
 #pragma once
 
+#include "acSweep.hpp"
 #include "boardBackgroundQuad.hpp"
 #include "boardStorage.hpp"
 #include "component.hpp"
 #include "gestureDetector.hpp"
+#include "mnaSystem.hpp"
+#include "monteCarlo.hpp"
 #include "observer.hpp"
 #include "pipeline.hpp"
+#include "resultCache.hpp"
+#include "simulationProgress.hpp"
 #include "simulationType.hpp"
+#include "transientSimulation.hpp"
 #include "vec2.hpp"
 #include "widget.hpp"
 #include <functional>
+#include <map>
+#include <memory>
 #include <optional>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 
 
@@ -44,6 +54,30 @@ struct BoardView {
 		std::optional<squi::Child> selectionWidget{};
 		std::unordered_set<ElementId> selectedWidgets{};
 		std::vector<squi::Child> nodeIndexes{};
+		// Widgets of what is on the board, boardStorage keeps them in sync through its listeners
+		std::map<ElementId, squi::Child> elementWidgets{};
+		std::map<ElementId, squi::Child> lineWidgets{};
+		std::unordered_map<Coords, squi::Child> connectionWidgets{};
+		// Kept between runs so that only changing element values skips the symbolic analysis
+		std::optional<MnaSystem<double>> dcSystem{};
+		std::optional<MnaSystem<std::complex<float>>> acSystem{};
+		ACSweep::Settings sweepSettings{};
+		std::optional<MnaSystem<double>> transientSystem{};
+		TransientSimulation::Settings transientSettings{
+			.outputStride = 1,
+			.adaptive = true,
+		};
+		MonteCarlo::Settings monteCarloSettings{};
+		// Running an unchanged circuit again, or undoing back to one, reuses its last results
+		ResultCache resultCache{};
+		// Simulation running on a background thread, it uses the systems, settings and cache above until it is done
+		struct SimulationJob {
+			std::shared_ptr<SimulationProgress> progress = std::make_shared<SimulationProgress>();
+			// Creates the results widgets, called on the UI thread once the simulation is done
+			std::function<void(Impl &)> deliver{};
+			std::jthread thread{};
+		};
+		std::unique_ptr<SimulationJob> job{};
 		static constexpr float gridWidth = 20.f;
 
 		void onUpdate() override;
@@ -56,11 +90,15 @@ struct BoardView {
 		void arrangeChildren(squi::vec2 &pos) override;
 		void drawChildren() override;
 
+		// Widget of the element or line with the given id, empty if there is none
+		[[nodiscard]] squi::Child widgetOf(ElementId id) const;
 		void clickElement(squi::GestureDetector::Event);
 		void unselectAll();
 		void deleteSelected();
 		void clearNodeIndexes();
 		void hideResults();
+		void startSimulation(SimulationType type);
+		void showResults(const BoardStorage &board, const GraphDescriptor &graph, const squi::Child &viewer);
 
 	public:
 		Impl(const BoardView &args);
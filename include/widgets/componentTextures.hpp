@@ -0,0 +1,23 @@
+#pragma once
+
+#include "component.hpp"
+#include "components/componentStore.hpp"
+#include "samplerUniform.hpp"
+#include <optional>
+#include <vector>
+
+// GPU textures of the components, kept out of Component so the simulation core doesn't depend on the renderer
+// Indexed by the component id, the store is never resized so MsdfImage can keep references into it
+struct ComponentTextures {
+	std::optional<Engine::SamplerUniform> texture{};
+	std::optional<Engine::SamplerUniform> thumb{};
+
+	static std::vector<ComponentTextures> &store() {
+		static std::vector<ComponentTextures> ret(ComponentStore::components.size());
+		return ret;
+	}
+
+	static ComponentTextures &of(const Component &component) {
+		return store().at(component.id);
+	}
+};
\ No newline at end of file
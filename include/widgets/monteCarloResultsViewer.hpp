@@ -0,0 +1,19 @@
+#pragma once
+#include "monteCarlo.hpp"
+#include "observer.hpp"
+#include "widget.hpp"
+
+struct MonteCarloResultsViewer {
+	// Args
+	squi::Widget::Args widget{};
+	const GraphDescriptor &graph;
+	const BoardStorage &board;
+	const MonteCarlo &simulation;
+	squi::Observable<const std::vector<ElementId> &> elementSelector{};
+
+	struct Storage {
+		// Data
+	};
+
+	operator squi::Child() const;
+};
\ No newline at end of file
@@ -3,12 +3,15 @@
 #include "element.hpp"
 #include "observer.hpp"
 #include "widget.hpp"
+#include <functional>
 
 
 struct PropertyEditor {
 	// Args
 	squi::Widget::Args widget{};
 	const Element &element;
+	// Called once the edited properties are written to the element
+	std::function<void()> onSave{};
 
 	struct Storage {
 		// Data
@@ -20,6 +23,7 @@ struct PropertyEditor {
 		squi::VoidObservable saveObs{};
 		squi::VoidObservable propIndexChanged{};
 		const Element &element;
+		std::function<void()> onSave;
 	};
 
 	operator squi::Child() const;
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "observer.hpp"
+#include "property/propertyUtils.hpp"
+#include "widget.hpp"
+
+// Editors of the element properties, the properties themselves are plain data shared with the simulation core
+struct NumberPropertyInput {
+	// Args
+	squi::VoidObservable closeObs{};
+	squi::Observable<bool> focusObs{};
+	std::string_view name;
+	float &value;
+	float &tolerance;
+	NumberProperty::Distribution &distribution;
+
+	struct Storage {
+		// Data
+		float newValue;
+		float &value;
+		float newTolerance;
+		float &tolerance;
+		NumberProperty::Distribution newDistribution;
+		NumberProperty::Distribution &distribution;
+	};
+
+	operator squi::Child() const;
+};
+
+struct TextPropertyInput {
+	// Args
+	squi::VoidObservable closeObs{};
+	squi::Observable<bool> focusObs{};
+	std::string_view name;
+	std::string &value;
+
+	struct Storage {
+		// Data
+		std::string newValue;
+		std::string &value;
+	};
+
+	operator squi::Child() const;
+};
+
+[[nodiscard]] squi::Child createPropertyInput(const NumberProperty &property, const squi::VoidObservable &closeObs, const squi::Observable<bool> &focusObs);
+[[nodiscard]] squi::Child createPropertyInput(const TextProperty &property, const squi::VoidObservable &closeObs, const squi::Observable<bool> &focusObs);
+
+template<class T>
+concept EditableProperty = PropertyLike<T> && requires(const CleanedType<T> &a) {
+	{ createPropertyInput(a, squi::VoidObservable{}, squi::Observable<bool>{}) } -> std::same_as<squi::Child>;
+};
+
+template<size_t... I>
+consteval bool AllPropertiesEditable(std::index_sequence<I...> /*idx*/) {
+	return (EditableProperty<std::tuple_element_t<I, PropertiesTypes>> && ...);
+}
+
+static_assert(AllPropertiesEditable(std::make_index_sequence<std::tuple_size_v<PropertiesTypes>>{}), "All properties must have an input");
\ No newline at end of file
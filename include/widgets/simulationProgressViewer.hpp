@@ -0,0 +1,15 @@
+#pragma once
+#include "simulationProgress.hpp"
+#include "widget.hpp"
+#include <functional>
+#include <memory>
+
+// Shown in place of the results while a simulation runs in the background
+struct SimulationProgressViewer {
+	// Args
+	squi::Widget::Args widget{};
+	std::shared_ptr<const SimulationProgress> progress;
+	std::function<void()> onCancel{};
+
+	operator squi::Child() const;
+};
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+#include "observer.hpp"
+#include "transientSimulation.hpp"
+#include "widget.hpp"
+
+struct TransientResultsViewer {
+	// Args
+	squi::Widget::Args widget{};
+	const GraphDescriptor &graph;
+	const BoardStorage &board;
+	const TransientSimulation &simulation;
+	squi::Observable<const std::vector<ElementId> &> elementSelector{};
+
+	struct Storage {
+		// Data
+	};
+
+	operator squi::Child() const;
+};
\ No newline at end of file
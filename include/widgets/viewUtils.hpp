@@ -0,0 +1,31 @@
+#pragma once
+
+#include "component.hpp"
+#include "coords.hpp"
+#include "vec2.hpp"
+
+// Conversions between the board grid and the screen, only the editor needs them
+namespace Utils {
+	Coords screenToGridRounded(const squi::vec2 &screen, const squi::vec2 &offset, const squi::vec2 &boardPos);
+	Coords screenToGridFloored(const squi::vec2 &screen, const squi::vec2 &offset, const squi::vec2 &boardPos);
+
+	[[nodiscard]] inline squi::vec2 toVec(const Coords &coords) {
+		return {
+			static_cast<float>(coords.x),
+			static_cast<float>(coords.y),
+		};
+	}
+
+	[[nodiscard]] inline squi::vec2 toVec(const Uv &uv) {
+		return {uv.x, uv.y};
+	}
+
+	struct RotatedElementData {
+		squi::vec2 newTopLeft{};
+		squi::vec2 newTopRight{};
+		squi::vec2 newBottomRight{};
+		squi::vec2 newBottomLeft{};
+		std::vector<Coords> newNodes{};
+	};
+	RotatedElementData rotateElement(uint32_t rotation, const Component &comp);
+}// namespace Utils
\ No newline at end of file
@@ -19,15 +19,17 @@ inline float getPhase(const std::complex<float> &val) {
 	return std::atan2(val.imag(), val.real()) / std::numbers::pi_v<float> * 180.f;
 }
 
-std::vector<Graph::LineValue> generateGraphData(const std::complex<float> &val) {
+std::vector<Graph::LineValue> generateGraphData(const std::complex<float> &val, float frequency) {
 	std::vector<Graph::LineValue> data{};
 	data.reserve(1000);
 	const auto phase = std::atan2(val.imag(), val.real());
 	const auto magnitude = std::sqrt(val.real() * val.real() + val.imag() * val.imag()) * std::sqrt(2.f);
-	const auto angularFrequency = 50.f * 2.f * std::numbers::pi_v<float>;
+	const auto angularFrequency = frequency * 2.f * std::numbers::pi_v<float>;
+	// Always show 5 periods, whatever the frequency
+	const auto timeStep = 5.f / (100.f * frequency);
 	for (int i = 0; i < 100; i++) {
 		data.emplace_back(Graph::LineValue{
-			.value = magnitude * std::sin(angularFrequency * static_cast<float>(i) / 1000.f + phase),
+			.value = magnitude * std::sin(angularFrequency * static_cast<float>(i) * timeStep + phase),
 			.x = static_cast<float>(i),
 		});
 	}
@@ -59,24 +61,32 @@ ACResultsViewer::operator squi::Child() const {
 				},
 			};
 
+			if (!graph.elementsOf(8).empty()) {
+				ret.emplace_back(ResultsCard{
+					.title = "Not simulated",
+					.columns{"Reason"},
+					.children{
+						ResultsItem{
+							.items{"Diodes aren't supported by this analysis yet"},
+						},
+					},
+				});
+			}
+
 			if (!simulation.voltages.empty()) {
 				Children voltRet{};
 				for (const auto &[index, val]: simulation.voltages | std::views::enumerate) {
+					const auto nodeLines = graph.linesAt(static_cast<uint32_t>(index + 1));
 					voltRet.emplace_back(ResultsItem{
 						.items{
 							std::format("Node #{}", index + 1),
 							std::format("{}V", std::sqrt(val.real() * val.real() + val.imag() * val.imag())),
 							std::format("{}°", getPhase(val)),
 						},
-						.onClick = [elementSelector = elementSelector, node = graph.nodes.at(index + 1), graphDataUpdater, val]() {
-							std::vector<ElementId> ret{};
-							ret.reserve(node.lines.size());
-							for (const auto &line: node.lines) {
-								ret.emplace_back(line.id);
-							}
-							elementSelector.notify(ret);
+						.onClick = [elementSelector = elementSelector, lines = std::vector<ElementId>{nodeLines.begin(), nodeLines.end()}, graphDataUpdater, val, frequency = simulation.frequency]() {
+							elementSelector.notify(lines);
 
-							graphDataUpdater.notify(generateGraphData(val));
+							graphDataUpdater.notify(generateGraphData(val, frequency));
 						},
 					});
 				}
@@ -96,10 +106,10 @@ ACResultsViewer::operator squi::Child() const {
 							std::format("{}V", std::sqrt(val.value.real() * val.value.real() + val.value.imag() * val.value.imag())),
 							std::format("{}°", getPhase(val.value)),
 						},
-						.onClick = [elementSelector = elementSelector, id = val.id, graphDataUpdater, val]() {
+						.onClick = [elementSelector = elementSelector, id = val.id, graphDataUpdater, val, frequency = simulation.frequency]() {
 							elementSelector.notify({id});
 
-							graphDataUpdater.notify(generateGraphData(val.value));
+							graphDataUpdater.notify(generateGraphData(val.value, frequency));
 						},
 					});
 				}
@@ -1,157 +1,88 @@
 #include "acSimulation.hpp"
 #include "complex"
+#include "mnaSystem.hpp"
 #include "numbers"
-#include "ranges"
 
 
-ACSimulation::ACSimulation(const GraphDescriptor &graph) {
-	using namespace std::literals;
-	if (graph.nodes.size() < 2) return;
-	auto incidenceMatrix = generateIncidenceMatrix(graph);
-	auto A = Eigen::MatrixXf(incidenceMatrix.bottomRows(incidenceMatrix.rows() - 1));
-	auto [mat, piv] = Utils::calculateNonzeroPivots(A);
-	auto Ar = Eigen::MatrixXf(A(Eigen::all, piv));
-	std::vector<int64_t> indices = [&]() {
-		auto temp = Eigen::Vector<int64_t, Eigen::Dynamic>::LinSpaced(mat.cols(), 0, mat.cols() - 1);
-		return std::vector<int64_t>(temp.begin(), temp.end());
-	}();
-	indices.erase(
-		std::remove_if(
-			indices.begin(),
-			indices.end(),
-			[&](const int &val) mutable -> bool {
-				auto res = std::equal_range(piv.begin(), piv.end(), val);
-				return res.first != res.second;
-			}
-		),
-		indices.end()
-	);
-	auto Ac = A(Eigen::all, indices);
-
-	auto D = Ar.inverse() * Ac;
+ACSimulation::ACSimulation(const GraphDescriptor &graph, float frequency) {
+	std::optional<MnaSystem<std::complex<float>>> system{};
+	*this = ACSimulation(graph, system, frequency);
+}
 
-	auto Br = Eigen::MatrixXf(-D.transpose());
-	auto Bc = Eigen::MatrixXf::Identity(Br.rows(), Br.rows());
+ACSimulation::ACSimulation(const GraphDescriptor &graph, std::optional<MnaSystem<std::complex<float>>> &system, float frequency, SimulationProgress *progress, MnaRefactor refactor) : frequency(frequency) {
+	if (graph.nodeCount < 2) return;
+	// Leaving the diodes open would give the results of a different circuit
+	if (!graph.elementsOf(8).empty()) {
+		std::println("The A.C. analysis has no small signal model for diodes yet, circuits with diodes can only be solved in D.C.");
+		return;
+	}
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::assembly)) return;
+	MnaTopology newTopology{graph};
+	// Only redo the symbolic analysis when the circuit topology changed
+	if (!system.has_value() || system->topology().hash() != newTopology.hash() || system->topology() != newTopology) {
+		system.emplace(std::move(newTopology));
+	}
+	const auto &topology = system->topology();
 
-	auto B = Eigen::MatrixXf(Br.rows(), Br.cols() + Bc.cols());
-	B << Br, Bc;
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::factorization)) return;
+	if (!system->factorize(branchValues(graph, topology, frequency), refactor)) return;
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::solve)) return;
+	auto solution = system->solve();
+	if (!solution.has_value()) return;
 
-	std::vector<int64_t> Lp{};
-	std::vector<int64_t> Le{};
-	std::vector<int64_t> Lj{};
-	std::vector<ElementId> voltageSourceIds{};
-	for (const auto &[index, elem]: graph.elements | std::views::enumerate) {
-		const auto id = elem.second.element.component.get().id;
-		if (id == 2) {
-			Le.emplace_back(index);
-			voltageSourceIds.emplace_back(elem.second.element.id);
-		} else if (id == 3) {
-			Lj.emplace_back(index);
-		} else {
-			Lp.emplace_back(index);
-		}
+	const auto nodeCount = static_cast<int64_t>(topology.nodeCount) - 1;
+	voltages.reserve(nodeCount);
+	for (const auto &val: solution->head(nodeCount)) {
+		voltages.emplace_back(val);
 	}
 
-	auto Ap = A(Eigen::all, Lp);
-	auto Ae = A(Eigen::all, Le);
-	auto Aj = A(Eigen::all, Lj);
-
-	auto Bp = B(Eigen::all, Lp);
-	auto Be = B(Eigen::all, Le);
-	auto Bj = B(Eigen::all, Lj);
+	currents.reserve(topology.voltageSourceCount);
+	int64_t sourceIndex = nodeCount;
+	for (const auto &branch: topology.branches) {
+		if (branch.type != MnaBranch::Type::voltageSource) continue;
+		currents.emplace_back(branch.id, (*solution)(sourceIndex++));
+	}
+}
 
-	auto Z = Eigen::VectorXcf::Zero(static_cast<int64_t>(Lp.size())).eval();
-	auto Enum = Eigen::VectorXcf::Zero(static_cast<int64_t>(Le.size())).eval();
-	auto Jnum = Eigen::VectorXcf::Zero(static_cast<int64_t>(Lj.size())).eval();
-	int64_t Zi = 0;
-	int64_t Ei = 0;
-	int64_t Ji = 0;
-	const auto frequency = 50.f;
+std::vector<std::complex<float>> ACSimulation::branchValues(const GraphDescriptor &graph, const MnaTopology &topology, float frequency) {
+	using namespace std::literals;
+	std::vector<std::complex<float>> params{};
+	params.reserve(topology.branches.size());
 	const auto omega = 2.f * std::numbers::pi_v<float> * frequency;
-	for (const auto &[_, elem]: graph.elements) {
-		const auto &element = elem.element;
-		const auto id = elem.element.component.get().id;
+	for (const auto &[index, element]: graph.elements | std::views::enumerate) {
+		const auto id = element.component.get().id;
 		if (id == 2) {
 			// Voltage source
 			if (element.propertySetIndex == 0) {
-				Enum(Ei++) = 0;
+				params.emplace_back(0.f);
 				continue;
 			}
-			const auto amplitude = getFloat(element.propertiesValues.at(0));
-			const auto phase = getFloat(element.propertiesValues.at(1)) * std::numbers::pi_v<float> / 180.f;
-			Enum(Ei++) = amplitude * std::exp(1if * phase);
+			const auto amplitude = graph.value(index, 0);
+			const auto phase = graph.value(index, 1) * std::numbers::pi_v<float> / 180.f;
+			params.emplace_back(amplitude * std::exp(1if * phase));
 		} else if (id == 3) {
 			// Current source
 			if (element.propertySetIndex == 0) {
-				Jnum(Ji++) = 0;
+				params.emplace_back(0.f);
 				continue;
 			}
-			const auto amplitude = getFloat(element.propertiesValues.at(0));
-			const auto phase = getFloat(element.propertiesValues.at(1)) * 180.f / std::numbers::pi_v<float>;
-			Jnum(Ji++) = amplitude * std::exp(1if * phase);
+			const auto amplitude = graph.value(index, 0);
+			const auto phase = graph.value(index, 1) * 180.f / std::numbers::pi_v<float>;
+			params.emplace_back(amplitude * std::exp(1if * phase));
 		} else if (id == 4) {
 			// Resistor
-			Z(Zi++) = getFloat(element.propertiesValues.at(0));
+			params.emplace_back(1.f / graph.value(index, 0));
 		} else if (id == 6) {
 			// Capacitor
-			Z(Zi++) = -1if * (1.f / (omega * getFloat(element.propertiesValues.at(0))));
+			params.emplace_back(1.f / (-1if * (1.f / (omega * graph.value(index, 0)))));
 		} else if (id == 7) {
 			// Inductor
-			Z(Zi++) = 1if * omega * getFloat(element.propertiesValues.at(0));
+			params.emplace_back(1.f / (1if * omega * graph.value(index, 0)));
+		} else if (id == 8) {
+			// Diode, there is no small signal model yet, the simulations refuse circuits with diodes before getting here
+			params.emplace_back(0.f);
 		}
 	}
-	auto Znum = Z.asDiagonal();
-
-	auto Ynum = Znum.inverse();
-	auto temp1 = Ap * Ynum * Ap.transpose();
-
-	auto Pb = Eigen::MatrixXcf(temp1.rows() + Le.size(), temp1.cols() + Ae.cols());
-	Pb << temp1,
-		Ae,
-		Ae.transpose(),
-		Eigen::MatrixXcf::Zero(static_cast<int64_t>(Le.size()), static_cast<int64_t>(Le.size()));
-
-	Eigen::MatrixXcf Qb;
-	if (Jnum.size() != 0) {
-		auto _ = Aj * Jnum;
-		Qb.resize(_.rows() + Enum.rows(), _.cols());
-		Qb << -_, -Enum;
-	} else {
-		Qb.resize(static_cast<int64_t>(graph.nodes.size() - 1) + Enum.rows(), 1);
-		Qb << -Eigen::MatrixXcf::Zero(static_cast<int64_t>(graph.nodes.size() - 1), 1), -Enum;
-	}
-
-	auto Xb = Pb.inverse() * Qb;
-
-	auto V_numeric = Xb.topRows(graph.nodes.size() - 1).eval();
-	auto Ie_numeric_b = Xb.bottomRows(Xb.rows() - (graph.nodes.size() - 1)).eval();
-	std::println("V_numeric");
-	std::cout << V_numeric << std::endl;
-	std::println("Ie_numeric_b");
-	std::cout << Ie_numeric_b << std::endl;
-
-	currents.reserve(Ie_numeric_b.rows());
-	for (const auto &[val, id]: std::views::zip(Ie_numeric_b.reshaped(), voltageSourceIds)) {
-		currents.emplace_back(id, val);
-	}
-
-	voltages.reserve(V_numeric.rows());
-	for (auto &val: V_numeric.reshaped()) {
-		voltages.emplace_back(val);
-	}
-}
-
-Eigen::MatrixXf ACSimulation::generateIncidenceMatrix(const GraphDescriptor &graph) {
-	Eigen::MatrixXf ret{};
-	ret.resize(
-		static_cast<int64_t>(graph.nodes.size()),
-		static_cast<int64_t>(graph.elements.size())
-	);
-	ret.fill(0);
-	for (const auto &[index, elem]: graph.elements | std::views::enumerate) {
-		ret.col(index)(elem.second.nodes.at(0)) = 1;
-		ret.col(index)(elem.second.nodes.at(1)) = -1;
-	}
 
-	return ret;
+	return params;
 }
@@ -0,0 +1,128 @@
+#include "acSweep.hpp"
+#include "acSimulation.hpp"
+#include "complex"
+#include "numbers"
+#include "threadPool.hpp"
+
+
+std::vector<float> ACSweep::Settings::frequencies() const {
+	std::vector<float> ret{};
+	if (startFrequency <= 0.f || stopFrequency < startFrequency || points == 0) return ret;
+
+	switch (scale) {
+		case Scale::linear: {
+			if (points == 1) {
+				ret.emplace_back(startFrequency);
+				break;
+			}
+			ret.reserve(points);
+			const auto step = (stopFrequency - startFrequency) / static_cast<float>(points - 1);
+			for (uint32_t i = 0; i < points; i++) {
+				ret.emplace_back(startFrequency + step * static_cast<float>(i));
+			}
+			break;
+		}
+		case Scale::decade:
+		case Scale::octave: {
+			const auto base = scale == Scale::decade ? 10.0 : 2.0;
+			const auto intervals = std::log(static_cast<double>(stopFrequency) / startFrequency) / std::log(base);
+			// The stop frequency is included even when it doesn't land exactly on a point
+			const auto count = static_cast<uint32_t>(std::floor(intervals * points + 1e-6)) + 1;
+			ret.reserve(count + 1);
+			for (uint32_t i = 0; i < count; i++) {
+				ret.emplace_back(static_cast<float>(startFrequency * std::pow(base, static_cast<double>(i) / points)));
+			}
+			if (ret.back() < stopFrequency * (1.f - 1e-6f)) ret.emplace_back(stopFrequency);
+			break;
+		}
+	}
+
+	return ret;
+}
+
+ACSweep::ACSweep(const GraphDescriptor &graph, const Settings &settings) {
+	std::optional<MnaSystem<std::complex<float>>> system{};
+	*this = ACSweep(graph, settings, system);
+}
+
+ACSweep::ACSweep(const GraphDescriptor &graph, const Settings &settings, std::optional<MnaSystem<std::complex<float>>> &system, SimulationProgress *progress)
+	: settings(settings), frequencies(settings.frequencies()) {
+	if (graph.nodeCount < 2 || frequencies.empty()) return;
+	// Leaving the diodes open would give the results of a different circuit
+	if (!graph.elementsOf(8).empty()) {
+		std::println("The A.C. sweep has no small signal model for diodes yet, circuits with diodes can only be solved in D.C.");
+		return;
+	}
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::assembly)) return;
+	MnaTopology newTopology{graph};
+	if (!system.has_value() || system->topology().hash() != newTopology.hash() || system->topology() != newTopology) {
+		system.emplace(std::move(newTopology));
+	}
+	const auto &topology = system->topology();
+
+	const auto nodeCount = static_cast<int64_t>(topology.nodeCount) - 1;
+	const auto pointCount = frequencies.size();
+	const auto allocateTrace = [&]() {
+		return Trace{
+			.magnitude = std::vector<float>(pointCount),
+			.phase = std::vector<float>(pointCount),
+		};
+	};
+	voltages.reserve(nodeCount);
+	for (int64_t i = 0; i < nodeCount; i++) {
+		voltages.emplace_back(allocateTrace());
+	}
+	currents.reserve(topology.voltageSourceCount);
+	for (const auto &branch: topology.branches) {
+		if (branch.type != MnaBranch::Type::voltageSource) continue;
+		currents.emplace_back(CurrentTrace{.id = branch.id, .trace = allocateTrace()});
+	}
+
+	// Every worker gets its own copy of the system, they all share the ordering and pattern of the original
+	auto &pool = ThreadPool::shared();
+	std::vector<std::optional<MnaSystem<std::complex<float>>>> workerSystems(pool.size());
+	std::atomic<size_t> failedPoints = 0;
+	std::atomic<size_t> donePoints = 0;
+
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::solve)) return;
+	pool.parallelFor(pointCount, [&](size_t workerIndex, size_t pointIndex) {
+		if (SimulationProgress::cancelled(progress)) return;
+		auto &workerSystem = workerSystems.at(workerIndex);
+		if (!workerSystem.has_value()) workerSystem.emplace(*system);
+
+		const auto store = [pointIndex](Trace &trace, const std::complex<float> &value) {
+			trace.magnitude.at(pointIndex) = std::abs(value);
+			trace.phase.at(pointIndex) = std::arg(value) / std::numbers::pi_v<float> * 180.f;
+		};
+
+		const auto frequency = frequencies.at(pointIndex);
+		std::optional<MnaSystem<std::complex<float>>::Vector> solution{};
+		if (workerSystem->refactor(ACSimulation::branchValues(graph, topology, frequency))) {
+			solution = workerSystem->solve();
+		}
+		if (!solution.has_value()) {
+			failedPoints++;
+			for (auto &trace: voltages) store(trace, std::numeric_limits<float>::quiet_NaN());
+			for (auto &current: currents) store(current.trace, std::numeric_limits<float>::quiet_NaN());
+			SimulationProgress::advance(progress, static_cast<float>(++donePoints) / static_cast<float>(pointCount));
+			return;
+		}
+
+		for (int64_t i = 0; i < nodeCount; i++) {
+			store(voltages.at(i), (*solution)(i));
+		}
+		for (size_t i = 0; i < currents.size(); i++) {
+			store(currents.at(i).trace, (*solution)(nodeCount + static_cast<int64_t>(i)));
+		}
+		SimulationProgress::advance(progress, static_cast<float>(++donePoints) / static_cast<float>(pointCount));
+	});
+	if (SimulationProgress::cancelled(progress)) {
+		voltages.clear();
+		currents.clear();
+		return;
+	}
+
+	if (failedPoints > 0) {
+		std::println("A.C. sweep: {} of {} frequency points could not be solved", failedPoints.load(), pointCount);
+	}
+}
@@ -0,0 +1,131 @@
+#include "acSweepResultsViewer.hpp"
+#include "card.hpp"
+#include "graphView.hpp"
+#include "resultsCard.hpp"
+#include "resultsItem.hpp"
+#include "scrollableFrame.hpp"
+
+
+using namespace squi;
+
+static inline std::vector<std::string_view> columnNames{
+	"Index",
+	"Peak",
+	"Peak frequency",
+};
+
+// Magnitude in dB over the frequency, logarithmic sweeps are plotted over log10(f)
+std::vector<Graph::LineValue> generateBodeData(const ACSweep &sweep, const ACSweep::Trace &trace) {
+	std::vector<Graph::LineValue> data{};
+	data.reserve(sweep.frequencies.size());
+	const bool logarithmic = sweep.settings.scale != ACSweep::Scale::linear;
+	for (const auto &[frequency, magnitude]: std::views::zip(sweep.frequencies, trace.magnitude)) {
+		if (std::isnan(magnitude)) continue;
+		data.emplace_back(Graph::LineValue{
+			.value = 20.f * std::log10(std::max(magnitude, std::numeric_limits<float>::min())),
+			.x = logarithmic ? std::log10(frequency) : frequency,
+		});
+	}
+
+	return data;
+}
+
+std::pair<float, float> getPeak(const ACSweep &sweep, const ACSweep::Trace &trace) {
+	std::pair<float, float> ret{0.f, 0.f};
+	for (const auto &[frequency, magnitude]: std::views::zip(sweep.frequencies, trace.magnitude)) {
+		if (magnitude > ret.first) ret = {magnitude, frequency};
+	}
+	return ret;
+}
+
+ACSweepResultsViewer::operator squi::Child() const {
+	auto storage = std::make_shared<Storage>();
+	// The traces are only turned into graph data when clicked, the lambdas share this single copy of the results
+	auto sweep = std::make_shared<const ACSweep>(simulation);
+
+	return ScrollableFrame{
+		.widget{widget},
+		.scrollableWidget{
+			.padding = 4.f,
+		},
+		.spacing = 4.f,
+		.children = [&]() -> Children {
+			Observable<const std::vector<Graph::LineValue> &> graphDataUpdater{};
+			Children ret{
+				Card{
+					.child = GraphView{
+						.widget{
+							.height = 300.f,
+							.margin = 4.f,
+						},
+						.updateData = graphDataUpdater,
+						.values{},
+					},
+				},
+			};
+
+			if (!graph.elementsOf(8).empty()) {
+				ret.emplace_back(ResultsCard{
+					.title = "Not simulated",
+					.columns{"Reason"},
+					.children{
+						ResultsItem{
+							.items{"Diodes aren't supported by this analysis yet"},
+						},
+					},
+				});
+			}
+
+			if (!simulation.voltages.empty()) {
+				Children voltRet{};
+				for (const auto &[index, trace]: simulation.voltages | std::views::enumerate) {
+					const auto [peak, peakFrequency] = getPeak(simulation, trace);
+					const auto nodeLines = graph.linesAt(static_cast<uint32_t>(index + 1));
+					voltRet.emplace_back(ResultsItem{
+						.items{
+							std::format("Node #{}", index + 1),
+							std::format("{}V", peak),
+							std::format("{}Hz", peakFrequency),
+						},
+						.onClick = [elementSelector = elementSelector, lines = std::vector<ElementId>{nodeLines.begin(), nodeLines.end()}, graphDataUpdater, sweep, index]() {
+							elementSelector.notify(lines);
+
+							graphDataUpdater.notify(generateBodeData(*sweep, sweep->voltages.at(index)));
+						},
+					});
+				}
+				ret.emplace_back(ResultsCard{
+					.title = "Voltages",
+					.columns = columnNames,
+					.children = voltRet,
+				});
+			}
+
+			if (!simulation.currents.empty()) {
+				Children currRet{};
+				for (const auto &[index, current]: simulation.currents | std::views::enumerate) {
+					const auto [peak, peakFrequency] = getPeak(simulation, current.trace);
+					currRet.emplace_back(ResultsItem{
+						.items{
+							std::format("{} #{}", board.getElement(current.id).value().get().element.component.get().name, current.id),
+							std::format("{}A", peak),
+							std::format("{}Hz", peakFrequency),
+						},
+						.onClick = [elementSelector = elementSelector, id = current.id, graphDataUpdater, sweep, index]() {
+							elementSelector.notify({id});
+
+							graphDataUpdater.notify(generateBodeData(*sweep, sweep->currents.at(index).trace));
+						},
+					});
+				}
+				ret.emplace_back(ResultsCard{
+					.title = "Currents",
+					.columns = columnNames,
+					.children = currRet,
+				});
+			}
+
+			return ret;
+		}(),
+	};
+}
@@ -2,6 +2,7 @@
 #include "boardStorage.hpp"
 #include "column.hpp"
 #include "component.hpp"
+#include "componentTextures.hpp"
 #include "config.hpp"
 #include "coords.hpp"
 #include "element.hpp"
@@ -12,6 +13,7 @@
 #include "stack.hpp"
 #include "stateContainer.hpp"
 #include "text.hpp"
+#include "viewUtils.hpp"
 #include <GLFW/glfw3.h>
 
 
@@ -51,6 +53,27 @@ struct PropertyDisplay {
 	}
 };
 
+// Labels show the name they connect by instead of their properties
+struct LabelDisplay {
+	// Args
+	std::shared_ptr<BoardElement::Storage> storage;
+
+	static std::string getDisplayText(const std::shared_ptr<BoardElement::Storage> &storage) {
+		return NetIndex::labelOf(storage->boardStorage.getElement(storage->elementId)->get().element).value_or("");
+	}
+
+	operator squi::Child() const {
+		return Text{
+			.widget{
+				.onUpdate = [storage = storage](Widget &w) {
+					w.as<Text::Impl>().setText(getDisplayText(storage));
+				},
+			},
+			.text = getDisplayText(storage),
+		};
+	}
+};
+
 struct PropertiesDisplay {
 	// Args
 	std::shared_ptr<BoardElement::Storage> storage;
@@ -68,6 +91,10 @@ struct PropertiesDisplay {
 	static Children getChildren(const std::shared_ptr<BoardElement::Storage> &storage) {
 		Children ret{};
 		const auto &elem = storage->boardStorage.getElement(storage->elementId)->get().element;
+		if (elem.component.get().type == ElementType::Label) {
+			ret.emplace_back(LabelDisplay{.storage = storage});
+			return ret;
+		}
 		for (const auto &[index, prop]: std::views::enumerate(elem.propertiesValues)) {
 			const auto &propData = elem.component.get().properties.at(elem.propertySetIndex).properties.at(index);
 			if (!propData.displayable) continue;
@@ -177,10 +204,10 @@ BoardElement::operator squi::Child() const {
 							pos += vec2(static_cast<float>(elem.element.pos.x), static_cast<float>(elem.element.pos.y)) * gridSize;
 						},
 					},
-					.texture = element.component.get().texture,
+					.texture = ComponentTextures::of(element.component.get()).texture,
 					.color{1.f, 1.f, 1.f, 1.f},
-					.uvTopLeft{element.component.get().uvTopLeft},
-					.uvBottomRight{element.component.get().uvBottomRight},
+					.uvTopLeft = Utils::toVec(element.component.get().uvTopLeft),
+					.uvBottomRight = Utils::toVec(element.component.get().uvBottomRight),
 				},
 				// Element name Text
 				element.component.get().prefix.empty()//
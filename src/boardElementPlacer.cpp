@@ -1,9 +1,11 @@
 #include "boardElementPlacer.hpp"
+#include "componentTextures.hpp"
 #include "config.hpp"
 #include "gestureDetector.hpp"
 #include "msdfImage.hpp"
 #include "observer.hpp"
 #include "utils.hpp"
+#include "viewUtils.hpp"
 #include "GLFW/glfw3.h"
 
 using namespace squi;
@@ -75,13 +77,13 @@ BoardElementPlacer::operator squi::Child() const {
 				.onArrange = [](Widget &w, vec2 &pos) {
 					auto &storage = w.customState.get<Storage>();
 
-					pos += storage.position.toVec() * gridSize;
+					pos += Utils::toVec(storage.position) * gridSize;
 				},
 			},
-			.texture = component.texture,
+			.texture = ComponentTextures::of(component).texture,
 			.color{1.f, 1.f, 1.f, 0.5f},
-			.uvTopLeft = component.uvTopLeft,
-			.uvBottomRight = component.uvBottomRight,
+			.uvTopLeft = Utils::toVec(component.uvTopLeft),
+			.uvBottomRight = Utils::toVec(component.uvBottomRight),
 		},
 	};
 }
@@ -1,6 +1,7 @@
 #include "boardLine.hpp"
 #include "boardStorage.hpp"
 #include "components/componentStore.hpp"
+#include "componentTextures.hpp"
 #include "config.hpp"
 #include "element.hpp"
 #include "elementState.hpp"
@@ -8,6 +9,7 @@
 #include "msdfImage.hpp"
 #include "observer.hpp"
 #include "vec2.hpp"
+#include "viewUtils.hpp"
 #include <GLFW/glfw3.h>
 #include <cassert>
 
@@ -78,7 +80,7 @@ BoardLine::operator squi::Child() const {
 				},
 				.onArrange = [](Widget &w, vec2 &pos) {
 					auto &storage = w.customState.get<Storage>();
-					pos += Coords::min(storage.startPos, storage.endPos).toVec() * gridSize;
+					pos += Utils::toVec(Coords::min(storage.startPos, storage.endPos)) * gridSize;
 
 					if (storage.startPos.x == storage.endPos.x) {
 						pos.x -= gridSize / 2.f;
@@ -87,10 +89,10 @@ BoardLine::operator squi::Child() const {
 					}
 				},
 			},
-			.texture = comp.texture,
+			.texture = ComponentTextures::of(comp).texture,
 			.color{1.f, 1.f, 1.f, 1.f},
-			.uvTopLeft{comp.uvTopLeft},
-			.uvBottomRight{comp.uvBottomRight},
+			.uvTopLeft = Utils::toVec(comp.uvTopLeft),
+			.uvBottomRight = Utils::toVec(comp.uvBottomRight),
 		},
 	};
 }
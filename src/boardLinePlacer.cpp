@@ -1,9 +1,11 @@
 #include "boardLinePlacer.hpp"
+#include "componentTextures.hpp"
 #include "config.hpp"
 #include "gestureDetector.hpp"
 #include "msdfImage.hpp"
 #include "observer.hpp"
 #include "utils.hpp"
+#include "viewUtils.hpp"
 #include "GLFW/glfw3.h"
 
 using namespace squi;
@@ -88,7 +90,7 @@ BoardLinePlacer::operator squi::Child() const {
 				.onArrange = [](Widget &w, vec2 &pos) {
 					auto &storage = w.customState.get<Storage>();
 					const auto minPos = Coords::min(storage.startPos, storage.endPos);
-					pos += minPos.toVec() * gridSize;
+					pos += Utils::toVec(minPos) * gridSize;
 					if (storage.startPos.x == storage.endPos.x) {
 						pos.x -= gridSize / 2.f;
 					} else {
@@ -96,10 +98,10 @@ BoardLinePlacer::operator squi::Child() const {
 					}
 				},
 			},
-			.texture = component.get().texture,
+			.texture = ComponentTextures::of(component.get()).texture,
 			.color{1.f, 1.f, 1.f, 0.5f},
-			.uvTopLeft{component.get().uvTopLeft},
-			.uvBottomRight{component.get().uvBottomRight},
+			.uvTopLeft = Utils::toVec(component.get().uvTopLeft),
+			.uvBottomRight = Utils::toVec(component.get().uvBottomRight),
 		},
 	};
 }
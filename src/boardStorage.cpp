@@ -1,20 +1,16 @@
 #include "boardStorage.hpp"
-
-#include "../extern/portable-file-dialogs/portable-file-dialogs.h"
-
-#include "boardElement.hpp"
-#include "boardLine.hpp"
 #include "components/componentStore.hpp"
-#include "config.hpp"
-#include "msdfImage.hpp"
 #include "saveData.hpp"
+#include "threadPool.hpp"
+#include "utils.hpp"
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <ranges>
+#include <sstream>
 
 
-using namespace squi;
-
-void BoardStorage::save() {
+bool BoardStorage::saveToFile(const std::filesystem::path &path) const {
 	SaveData ret{};
 	ret.elements.reserve(elements.size());
 	for (const auto &elem: elements) {
@@ -55,136 +51,119 @@ void BoardStorage::save() {
 
 	auto serialized = ret.serialize();
 
-	auto pathStr = pfd::save_file(
-					   "Save",
-					   {},
-					   {
-						   "Circuit Simulator Save File (*.sqcs)",
-						   "*.sqcs",
-						   "All Files (*.*)",
-						   "*",
-					   }
-	)
-					   .result();
-
-	if (!pathStr.empty()) {
-		std::filesystem::path path(pathStr);
-		std::println("Saving to: {}", path.string());
-		std::ofstream out(path, std::ios::trunc | std::ios::out | std::ios::binary);
-		out.write(std::bit_cast<char *>(serialized.data()), static_cast<int64_t>(serialized.size()));
-		out.close();
+	std::ofstream out(path, std::ios::trunc | std::ios::out | std::ios::binary);
+	if (!out.is_open()) {
+		std::println("Failed to open {} for saving", path.string());
+		return false;
 	}
+	out.write(std::bit_cast<char *>(serialized.data()), static_cast<int64_t>(serialized.size()));
+	out.close();
+	return true;
 }
 
-void BoardStorage::load() {
-	auto pathStr = pfd::open_file(
-					   "Load",
-					   {},
-					   {
-						   "Circuit Simulator Save File (*.sqcs)",
-						   "*.sqcs",
-						   "All Files (*.*)",
-						   "*",
-					   }
-	)
-					   .result();
-
-	if (!pathStr.empty()) {
-		std::filesystem::path path(pathStr.front());
-		std::println("Loading save: {}", path.string());
-		std::ifstream in(path, std::ios::in | std::ios::binary);
-		if (!in.is_open()) {
-			std::println("Failed to open save file");
-			return;
-		}
-		std::stringstream contents{};
-		contents << in.rdbuf();
-		in.close();
-
-		SaveData data{};
-		auto contentsView = contents.view();
-		data.deserialize(std::span<const std::byte>(
-			std::bit_cast<const std::byte *>(&*contentsView.begin()),
+bool BoardStorage::loadFromFile(const std::filesystem::path &path) {
+	std::ifstream in(path, std::ios::in | std::ios::binary);
+	if (!in.is_open()) {
+		std::println("Failed to open save file");
+		return false;
+	}
+	std::stringstream contents{};
+	contents << in.rdbuf();
+	in.close();
+
+	SaveData data{};
+	auto contentsView = contents.view();
+	if (!data.deserialize(std::span<const std::byte>(
+			std::bit_cast<const std::byte *>(contentsView.data()),
 			contentsView.size()
-		));
-
-		elements.clear();
-		elementTiles.clear();
-		lines.clear();
-		lineTiles.clear();
-		connections.clear();
-
-		uint32_t maxId = 0;
-
-		const auto &lineComponent = ComponentStore::components.at(0).get();
-		for (auto &elem: data.elements) {
-			maxId = std::max(maxId, elem.id);
-
-			const auto &component = ComponentStore::components.at(elem.type).get();
-
-			std::vector<PropertyVariant> properties{};
-
-			if (!component.properties.empty()) {
-				uint64_t propIndex = 0;
-				const auto &propertySet = component.properties.at(elem.propertySetIndex).properties;
-				for (auto it = data.properties.begin() + elem.propertyIndex; it != data.properties.begin() + elem.propertyIndex + elem.propertyCount; it++) {
-					std::span<const std::byte> span = *it;
-					auto index = Utils::staticBytesTo<size_t>(span.begin() + sizeof(size_t));
-					auto variant = Utils::FromIndex<PropertiesTypes>(index);
-					std::visit(
-						[&](auto &&val) {
-							properties.emplace_back(
-								std::decay_t<decltype(val)>::type::deserialize(
-									*it,
-									propertySet.at(propIndex++)
-								)
-							);
-						},
-						variant
-					);
-				}
-
-				for (; propIndex < propertySet.size(); propIndex++) {
-					properties.emplace_back(createProperty(propertySet.at(propIndex)));
-				}
-			}
+		))) {
+		std::println("Failed to read save file");
+		return false;
+	}
 
+	elements.clear();
+	elementTiles.clear();
+	lines.clear();
+	lineSegments.clear();
+	connections.clear();
+	// Finding the nets once everything is placed is quicker than keeping them up to date on every placement
+	nets.suspended = true;
+	if (listeners.cleared) listeners.cleared();
+
+	uint32_t maxId = 0;
+
+	const auto &lineComponent = ComponentStore::components.at(0).get();
+	for (auto &elem: data.elements) {
+		maxId = std::max(maxId, elem.id);
+
+		const auto &component = ComponentStore::components.at(elem.type).get();
+
+		std::vector<PropertyVariant> properties{};
+
+		if (!component.properties.empty()) {
+			uint64_t propIndex = 0;
+			const auto &propertySet = component.properties.at(elem.propertySetIndex).properties;
+			for (auto it = data.properties.begin() + elem.propertyIndex; it != data.properties.begin() + elem.propertyIndex + elem.propertyCount; it++) {
+				std::span<const std::byte> span = *it;
+				auto index = Utils::staticBytesTo<size_t>(span.begin() + sizeof(size_t));
+				auto variant = Utils::FromIndex<PropertiesTypes>(index);
+				const auto &propertyData = propertySet.at(propIndex++);
+				// Read as the type it was saved with, older saves can have a different type than the component has now
+				auto savedData = propertyData;
+				savedData.type = static_cast<PropertyIndex>(index);
+				std::visit(
+					[&](auto &&val) {
+						properties.emplace_back(convertProperty(
+							std::decay_t<decltype(val)>::type::deserialize(*it, savedData),
+							propertyData
+						));
+					},
+					variant
+				);
+			}
 
-			placeElement(Element{
-				.id = elem.id,
-				.size{Utils::componentSizeWithRotation(component, elem.rotation)},
-				.pos{elem.posX, elem.posY},
-				.rotation = elem.rotation,
-				.nodes{Utils::rotateElement(elem.rotation, component).newNodes},
-				.component = component,
-				.propertySetIndex = elem.propertySetIndex,
-				.propertiesValues = properties,
-			});
-		}
-		for (auto &line: data.lines) {
-			maxId = std::max(maxId, line.id);
-			auto startPos = Coords{line.startPosX, line.startPosY};
-			auto endPos = Coords{line.endPosX, line.endPosY};
-
-			auto endOffset = (startPos - endPos).abs();
-
-			Coords size = endOffset;
-			if (size.x == 0)
-				size.x++;
-			else
-				size.y++;
-
-			placeLine(Element{
-				.id = line.id,
-				.size{size},
-				.pos{Coords::min(startPos, endPos)},
-				.nodes{{0, 0}, endOffset},
-				.component = lineComponent,
-			});
+			for (; propIndex < propertySet.size(); propIndex++) {
+				properties.emplace_back(createProperty(propertySet.at(propIndex)));
+			}
 		}
 
-		Element::idCounter = maxId + 1;
+
+		placeElement(Element{
+			.id = elem.id,
+			.size{Utils::componentSizeWithRotation(component, elem.rotation)},
+			.pos{elem.posX, elem.posY},
+			.rotation = elem.rotation,
+			.nodes{Utils::rotateNodes(elem.rotation, component)},
+			.component = component,
+			.propertySetIndex = elem.propertySetIndex,
+			.propertiesValues = properties,
+		});
 	}
+	for (auto &line: data.lines) {
+		maxId = std::max(maxId, line.id);
+		auto startPos = Coords{line.startPosX, line.startPosY};
+		auto endPos = Coords{line.endPosX, line.endPosY};
+
+		auto endOffset = (startPos - endPos).abs();
+
+		Coords size = endOffset;
+		if (size.x == 0)
+			size.x++;
+		else
+			size.y++;
+
+		placeLine(Element{
+			.id = line.id,
+			.size{size},
+			.pos{Coords::min(startPos, endPos)},
+			.nodes{{0, 0}, endOffset},
+			.component = lineComponent,
+		});
+	}
+
+	nets.rebuild(*this, &ThreadPool::shared());
+	Element::idCounter = maxId + 1;
+	return true;
 }
 
 std::vector<ElementData>::const_iterator BoardStorage::lower_bound(const std::vector<ElementData> &rng, ElementId id) {
@@ -236,8 +215,9 @@ std::optional<std::reference_wrapper<const ElementData>> BoardStorage::getCloses
 		if (!_.has_value()) continue;
 		const auto &data = _->get();
 
-		const auto pos = data.element.pos.toVec() + data.element.size.toVec() / 2.f;
-		const auto distance = (coords.toVec() - pos).length();
+		const auto dx = static_cast<float>(coords.x) - (static_cast<float>(data.element.pos.x) + static_cast<float>(data.element.size.x) / 2.f);
+		const auto dy = static_cast<float>(coords.y) - (static_cast<float>(data.element.pos.y) + static_cast<float>(data.element.size.y) / 2.f);
+		const auto distance = std::hypot(dx, dy);
 		if (distance < ret.distance) {
 			ret.data = std::ref(data);
 			ret.distance = distance;
@@ -246,67 +226,68 @@ std::optional<std::reference_wrapper<const ElementData>> BoardStorage::getCloses
 
 	return ret.data;
 }
-squi::Child BoardStorage::createNodeChild(const Coords &coords) {
-	return MsdfImage{
-		.widget{
-			.width = gridSize,
-			.height = gridSize,
-			.onArrange = [coords](squi::Widget & /*w*/, squi::vec2 &pos) {
-				squi::vec2 offset(static_cast<float>(coords.x) * gridSize, static_cast<float>(coords.y) * gridSize);
-				offset -= gridSize / 2.f;
-				pos += offset;
-			},
-		},
-		.texture{ComponentStore::components.at(1).get().texture}
-	};
-}
+BoardStorage::BoxSelection BoardStorage::selectBox(const Coords &min, const Coords &max) const {
+	BoxSelection ret{};
+	for (auto x: std::views::iota(min.x, max.x)) {
+		for (auto y: std::views::iota(min.y, max.y)) {
+			if (auto it = elementTiles.find(Coords{x, y}); it != elementTiles.end()) {
+				ret.elements.insert(ret.elements.end(), it->second.begin(), it->second.end());
+			}
+		}
+	}
+	lineSegments.forEachInBox(min, max, [&](ElementId id) {
+		ret.lines.emplace_back(id);
+	});
 
-void BoardStorage::ensureConnectionNode(ConnectionNode &node, const Coords &coords) {
-	if (!node.widget) {
-		node.widget = createNodeChild(coords);
+	// Elements span several tiles
+	for (auto *ids: {&ret.elements, &ret.lines}) {
+		std::ranges::sort(*ids);
+		const auto [first, last] = std::ranges::unique(*ids);
+		ids->erase(first, last);
 	}
+	return ret;
+}
+
+BoardStorage BoardStorage::snapshot() const {
+	return BoardStorage{
+		.lines = lines,
+		.elements = elements,
+		.lineSegments = lineSegments,
+		.elementTiles = elementTiles,
+		.connections = connections,
+		.nets = nets,
+	};
 }
 
 void BoardStorage::placeLine(const Element &elem) {
-	for (auto x: std::views::iota(elem.pos.x) | std::views::take(elem.size.x)) {
-		for (auto y: std::views::iota(elem.pos.y) | std::views::take(elem.size.y)) {
-			lineTiles[Coords{x, y}].emplace_back(elem.id);
-		}
-	}
+	lineSegments.add(elem);
 
 	for (const auto &[index, node]: elem.nodes | std::views::enumerate) {
 		auto &connectionNode = connections[elem.pos + node];
 		connectionNode.connections.emplace_back(index, elem.id);
-		ensureConnectionNode(connectionNode, node + elem.pos);
+		if (listeners.connectionPlaced) listeners.connectionPlaced(elem.pos + node);
 	}
 
-	lines.emplace(
-		upper_bound(lines, elem.id),
-		elem,
-		BoardLine{
-			.boardStorage = *this,
-			.element = elem,
-		}
-	);
+	lines.emplace(upper_bound(lines, elem.id), elem);
+	nets.linePlaced(*this, elem);
+	if (listeners.linePlaced) listeners.linePlaced(elem);
 }
 
 void BoardStorage::removeLine(ElementId id) {
 	const auto it = lower_bound(lines, id);
 	if (it == lines.end() || it->element.id != id) return;
-	it->widget->reDraw();
 	const auto &elem = it->element;
-	for (auto x: std::views::iota(elem.pos.x) | std::views::take(elem.size.x)) {
-		for (auto y: std::views::iota(elem.pos.y) | std::views::take(elem.size.y)) {
-			auto &tiles = lineTiles[Coords{x, y}];
-			tiles.erase(std::ranges::find(tiles, id));
-		}
-	}
+	lineSegments.remove(elem);
 
 	for (const auto &[index, node]: elem.nodes | std::views::enumerate) {
 		std::erase(connections[elem.pos + node].connections, Connection{static_cast<size_t>(index), id});
 	}
 
+	// The nets are only updated once the line is off the board
+	const auto removed = *it;
 	lines.erase(it);
+	nets.lineRemoved(*this, removed.element);
+	if (listeners.lineRemoved) listeners.lineRemoved(id);
 }
 
 void BoardStorage::placeElement(const Element &elem) {
@@ -319,23 +300,17 @@ void BoardStorage::placeElement(const Element &elem) {
 	for (const auto &[index, node]: elem.nodes | std::views::enumerate) {
 		auto &connectionNode = connections[elem.pos + node];
 		connectionNode.connections.emplace_back(index, elem.id);
-		ensureConnectionNode(connectionNode, node + elem.pos);
+		if (listeners.connectionPlaced) listeners.connectionPlaced(elem.pos + node);
 	}
 
-	elements.emplace(
-		upper_bound(elements, elem.id),
-		elem,
-		BoardElement{
-			.element = elem,
-			.boardStorage = *this,
-		}
-	);
+	elements.emplace(upper_bound(elements, elem.id), elem);
+	nets.elementPlaced(*this, elem);
+	if (listeners.elementPlaced) listeners.elementPlaced(elem);
 }
 
 void BoardStorage::removeElement(ElementId id) {
 	const auto it = lower_bound(elements, id);
 	if (it == elements.end()) return;
-	it->widget->reDraw();
 	const auto &elem = it->element;
 	for (auto x: std::views::iota(elem.pos.x) | std::views::take(elem.size.x)) {
 		for (auto y: std::views::iota(elem.pos.y) | std::views::take(elem.size.y)) {
@@ -348,5 +323,11 @@ void BoardStorage::removeElement(ElementId id) {
 		std::erase(connections[elem.pos + node].connections, Connection{static_cast<size_t>(index), id});
 	}
 
+	nets.elementRemoved(*this, elem);
 	elements.erase(it);
+	if (listeners.elementRemoved) listeners.elementRemoved(id);
+}
+
+void BoardStorage::propertiesChanged(ElementId id) {
+	if (const auto elem = getElement(id); elem.has_value()) nets.elementChanged(*this, elem->get().element);
 }
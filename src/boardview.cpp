@@ -1,6 +1,7 @@
 #include "boardview.hpp"
 #include "acResultsViewer.hpp"
 #include "acSimulation.hpp"
+#include "acSweepResultsViewer.hpp"
 #include "boardElement.hpp"
 #include "boardElementPlacer.hpp"
 #include "boardLine.hpp"
@@ -10,21 +11,29 @@
 #include "compiledShaders/boardBackgroundfrag.hpp"
 #include "compiledShaders/boardBackgroundvert.hpp"
 #include "component.hpp"
+#include "componentTextures.hpp"
 #include "components/componentStore.hpp"
+#include "config.hpp"
 #include "dcResultsViewer.hpp"
 #include "dcSimulation.hpp"
 #include "elementState.hpp"
 #include "gestureDetector.hpp"
 #include "graphDescriptor.hpp"
 #include "image.hpp"
+#include "monteCarloResultsViewer.hpp"
+#include "msdfImage.hpp"
 #include "nodeIndexDisplay.hpp"
 #include "propertyEditor.hpp"
 #include "resultsDisplay.hpp"
 #include "row.hpp"
 #include "samplerUniform.hpp"
+#include "threadPool.hpp"
+#include "simulationProgressViewer.hpp"
 #include "topBar.hpp"
+#include "transientResultsViewer.hpp"
 #include "utils.hpp"
 #include "vec2.hpp"
+#include "viewUtils.hpp"
 #include "widget.hpp"
 #include "window.hpp"
 #include <GLFW/glfw3.h>
@@ -32,12 +41,28 @@
 #include <cstdlib>
 #include <optional>
 #include <print>
+#include <thread>
 
 
 using namespace squi;
 
 BoardView::Pipeline *BoardView::pipeline = nullptr;
 
+static squi::Child createNodeChild(const Coords &coords) {
+	return MsdfImage{
+		.widget{
+			.width = gridSize,
+			.height = gridSize,
+			.onArrange = [coords](squi::Widget & /*w*/, squi::vec2 &pos) {
+				squi::vec2 offset(static_cast<float>(coords.x) * gridSize, static_cast<float>(coords.y) * gridSize);
+				offset -= gridSize / 2.f;
+				pos += offset;
+			},
+		},
+		.texture{ComponentTextures::of(ComponentStore::components.at(1)).texture}
+	};
+}
+
 BoardView::Impl::Impl(const BoardView &args)
 	: Widget(args.widget, Widget::FlagsArgs::Default()),
 	  gd(GestureDetector{
@@ -47,7 +72,7 @@ BoardView::Impl::Impl(const BoardView &args)
 			  if (selectedLineWidget.has_value()) {
 				  const auto clickCoords = Utils::screenToGridRounded(GestureDetector::getMousePos(), viewOffset, getPos());
 				  const bool connectionExists = !boardStorage.connections[clickCoords].connections.empty();
-				  const bool lineExists = !boardStorage.lineTiles[clickCoords].empty();
+				  const bool lineExists = !boardStorage.lineSegments.at(clickCoords).empty();
 				  selectedLineWidget.value()->customState.get<VoidObserver>().notifyOthers();
 				  if (connectionExists || lineExists) {
 					  selectedLineWidget.value()->deleteLater();
@@ -85,75 +110,78 @@ BoardView::Impl::Impl(const BoardView &args)
 		  selectedComponentWidget = child;
 	  })) {
 	customState.add(args.onRun.observe([&self = *this](SimulationType type) {
+		// The systems and the result cache belong to the running simulation until it is done
+		if (self.job) {
+			std::println("A simulation is already running");
+			return;
+		}
 		self.unselectAll();
 		self.hideResults();
-
-		GraphDescriptor descriptor{self.boardStorage};
-
-		for (const auto &elem: descriptor.elements) {
-			for (const auto &[nodeIndex, nodeCoords]: std::views::zip(elem.second.nodes, elem.second.element.nodes)) {
-				auto &_ = self.nodeIndexes.emplace_back(NodeIndexDisplay{
-					.nodeIndex = nodeIndex,
-					.pos = nodeCoords + elem.second.element.pos,
-				});
-
-				self.addChild(_);
-			}
-		}
-
-		switch (type) {
-			case SimulationType::acSim: {
-				self.resultsAdder.notify(ResultsDisplay{
-					.destroyObs = self.resultsDestroyer,
-					.child = ACResultsViewer{
-						.graph = descriptor,
-						.board = self.boardStorage,
-						.simulation = ACSimulation{descriptor},
-						.elementSelector = self.elementSelector,
-					},
-				});
-				break;
-			}
-			case SimulationType::dcSim: {
-				self.resultsAdder.notify(ResultsDisplay{
-					.destroyObs = self.resultsDestroyer,
-					.child = DCResultsViewer{
-						.graph = descriptor,
-						.board = self.boardStorage,
-						.simulation = DCSimulation{descriptor},
-						.elementSelector = self.elementSelector,
-					},
-				});
-				break;
-			}
-		}
+		self.startSimulation(type);
 	}));
 	customState.add(elementSelector.observe([&self = *this](const std::vector<ElementId> &ids) {
 		self.unselectAll();
 		for (const auto &id: ids) {
-			self.selectedWidgets.insert(id);
-			auto elem = self.boardStorage.getElement(id);
-			auto line = self.boardStorage.getLine(id);
-			if (line.has_value())
-				line->get().widget->customState.get<StateObservable>().notify(ElementState::selected);
-
-			if (elem.has_value())
-				elem->get().widget->customState.get<StateObservable>().notify(ElementState::selected);
+			if (auto widget = self.widgetOf(id)) {
+				self.selectedWidgets.insert(id);
+				widget->customState.get<StateObservable>().notify(ElementState::selected);
+			}
 		}
 	}));
+
+	boardStorage.listeners = BoardStorage::Listeners{
+		.elementPlaced = [this](const Element &elem) {
+			elementWidgets.insert_or_assign(elem.id, BoardElement{
+				.element = elem,
+				.boardStorage = boardStorage,
+			});
+		},
+		.linePlaced = [this](const Element &elem) {
+			lineWidgets.insert_or_assign(elem.id, BoardLine{
+				.boardStorage = boardStorage,
+				.element = elem,
+			});
+		},
+		.elementRemoved = [this](ElementId id) {
+			if (auto it = elementWidgets.find(id); it != elementWidgets.end()) {
+				it->second->reDraw();
+				elementWidgets.erase(it);
+			}
+		},
+		.lineRemoved = [this](ElementId id) {
+			if (auto it = lineWidgets.find(id); it != lineWidgets.end()) {
+				it->second->reDraw();
+				lineWidgets.erase(it);
+			}
+		},
+		.connectionPlaced = [this](const Coords &coords) {
+			if (!connectionWidgets.contains(coords)) {
+				connectionWidgets.emplace(coords, createNodeChild(coords));
+			}
+		},
+		.cleared = [this]() {
+			elementWidgets.clear();
+			lineWidgets.clear();
+			connectionWidgets.clear();
+		},
+	};
+}
+
+squi::Child BoardView::Impl::widgetOf(ElementId id) const {
+	if (auto it = elementWidgets.find(id); it != elementWidgets.end()) return it->second;
+	if (auto it = lineWidgets.find(id); it != lineWidgets.end()) return it->second;
+	return {};
 }
 
 void BoardView::Impl::onUpdate() {
 	// Initialize component textures
 	if (!loadedComponents) {
-		uint32_t idCounter = 0;
 		for (const auto &comp: ComponentStore::components) {
-			const_cast<uint32_t &>(comp.get().id) = idCounter++;
 			auto job = std::thread([&comp, &instance = Window::of(this).engine.instance] {
 				{
 					auto data = Image::Data::fromFile(comp.get().texturePath);
 
-					auto &sampler = const_cast<std::optional<Engine::SamplerUniform> &>(comp.get().texture).emplace(Engine::SamplerUniform::Args{
+					auto &sampler = ComponentTextures::of(comp.get()).texture.emplace(Engine::SamplerUniform::Args{
 						.instance = instance,
 						.textureArgs{
 							.instance = instance,
@@ -179,7 +207,7 @@ void BoardView::Impl::onUpdate() {
 				{
 					auto data = Image::Data::fromFile(comp.get().textureThumbPath);
 
-					auto &sampler = const_cast<std::optional<Engine::SamplerUniform> &>(comp.get().textureThumb).emplace(Engine::SamplerUniform::Args{
+					auto &sampler = ComponentTextures::of(comp.get()).thumb.emplace(Engine::SamplerUniform::Args{
 						.instance = instance,
 						.textureArgs{
 							.instance = instance,
@@ -208,6 +236,16 @@ void BoardView::Impl::onUpdate() {
 		loadedComponents = true;
 	}
 
+	// The results of a background simulation are turned into widgets here, on the UI thread
+	if (job && job->progress->stage == SimulationProgress::Stage::done) {
+		const auto finished = std::move(job);
+		finished->thread.join();
+		if (finished->deliver && !finished->progress->cancelled()) {
+			hideResults();
+			finished->deliver(*this);
+		}
+	}
+
 	const auto roundedGridPos = Utils::screenToGridRounded(GestureDetector::getMousePos(), viewOffset, getPos());
 
 	// Update drag selection
@@ -217,25 +255,14 @@ void BoardView::Impl::onUpdate() {
 			GestureDetector::isKey(GLFW_KEY_RIGHT_CONTROL, GLFW_RELEASE)) {
 
 			auto &storage = selectionWidget.value()->customState.get<BoardSelection::Storage>();
-			auto minPos = Coords::min(storage.startPos, storage.endPos);
-			auto maxPos = Coords::max(storage.startPos, storage.endPos);
-			for (auto x: std::views::iota(minPos.x, maxPos.x)) {
-				for (auto y: std::views::iota(minPos.y, maxPos.y)) {
-					if (auto it = boardStorage.elementTiles.find(Coords{x, y}); it != boardStorage.elementTiles.end()) {
-						for (auto elemId: it->second) {
-							selectedWidgets.insert(elemId);
-							auto elem = boardStorage.getElement(elemId);
-							elem->get().widget->customState.get<StateObservable>().notify(ElementState::selected);
-						}
-					}
-					if (auto it = boardStorage.lineTiles.find(Coords{x, y}); it != boardStorage.lineTiles.end()) {
-						for (auto &line: it->second) {
-							selectedWidgets.insert(line);
-							auto elem = boardStorage.getLine(line);
-							elem->get().widget->customState.get<StateObservable>().notify(ElementState::selected);
-						}
-					}
-				}
+			const auto selection = boardStorage.selectBox(Coords::min(storage.startPos, storage.endPos), Coords::max(storage.startPos, storage.endPos));
+			for (const auto &elemId: selection.elements) {
+				selectedWidgets.insert(elemId);
+				elementWidgets.at(elemId)->customState.get<StateObservable>().notify(ElementState::selected);
+			}
+			for (const auto &line: selection.lines) {
+				selectedWidgets.insert(line);
+				lineWidgets.at(line)->customState.get<StateObservable>().notify(ElementState::selected);
 			}
 
 			selectionWidget.value()->deleteLater();
@@ -274,15 +301,20 @@ void BoardView::Impl::onUpdate() {
 			);
 
 			if (closestElement.has_value()) {
-				Window::of(this).addOverlay(PropertyEditor{.element = closestElement->get().element});
+				Window::of(this).addOverlay(PropertyEditor{
+					.element = closestElement->get().element,
+					// Labels connect by name, so the nets can change with the properties
+					.onSave = [&boardStorage = boardStorage, id = closestElement->get().element.id]() {
+						boardStorage.propertiesChanged(id);
+					},
+				});
 			}
 		}
 	}
 
 	// Escape or Mouse2 -> unselect all selected elements
 	if (GestureDetector::isKeyPressedOrRepeat(GLFW_KEY_ESCAPE) || GestureDetector::isKeyPressedOrRepeat(GLFW_MOUSE_BUTTON_2)) {
-		resultsDestroyer.notify();
-		clearNodeIndexes();
+		hideResults();
 		unselectAll();
 	}
 
@@ -316,17 +348,16 @@ void BoardView::Impl::onDraw() {
 
 void BoardView::Impl::updateChildren() {
 	Widget::updateChildren();
-	const auto _ = {boardStorage.lines, boardStorage.elements};
-	for (const auto &line: _ | std::views::join) {
-		const auto &widget = line.widget;
+	const auto _ = {lineWidgets, elementWidgets};
+	for (const auto &[id, widget]: _ | std::views::join) {
 		if (!widget) continue;
 		widget->state.parent = this;
 		widget->state.root = state.root;
 		widget->update();
 	}
-	for (auto &[key, val]: boardStorage.connections) {
-		auto &widget = val.widget;
-		if (val.connections.empty()) continue;
+	for (auto &[coords, widget]: connectionWidgets) {
+		const auto &connections = boardStorage.connections.at(coords).connections;
+		if (connections.empty()) continue;
 		if (!widget) continue;
 
 		widget->state.parent = this;
@@ -342,17 +373,16 @@ squi::vec2 BoardView::Impl::layoutChildren(squi::vec2 /*maxSize*/, squi::vec2 /*
 		child->state.root = state.root;
 		child->layout(vec2::infinity(), vec2{}, {false, false}, final);
 	}
-	const auto _ = {boardStorage.lines, boardStorage.elements};
-	for (const auto &line: _ | std::views::join) {
-		const auto &widget = line.widget;
+	const auto _ = {lineWidgets, elementWidgets};
+	for (const auto &[id, widget]: _ | std::views::join) {
 		if (!widget) continue;
 		widget->state.parent = this;
 		widget->state.root = state.root;
 		widget->layout(vec2::infinity(), {}, {}, final);
 	}
-	for (auto &[key, val]: boardStorage.connections) {
-		auto &widget = val.widget;
-		if (val.connections.empty()) continue;
+	for (auto &[coords, widget]: connectionWidgets) {
+		const auto &connections = boardStorage.connections.at(coords).connections;
+		if (connections.empty()) continue;
 		if (!widget) continue;
 		widget->state.parent = this;
 		widget->state.root = state.root;
@@ -370,17 +400,16 @@ void BoardView::Impl::arrangeChildren(squi::vec2 &pos) {
 		child->state.root = state.root;
 		child->arrange(newPos);
 	}
-	const auto _ = {boardStorage.lines, boardStorage.elements};
-	for (const auto &line: _ | std::views::join) {
-		const auto &widget = line.widget;
+	const auto _ = {lineWidgets, elementWidgets};
+	for (const auto &[id, widget]: _ | std::views::join) {
 		if (!widget) continue;
 		widget->state.parent = this;
 		widget->state.root = state.root;
 		widget->arrange(newPos);
 	}
-	for (auto &[key, val]: boardStorage.connections) {
-		auto &widget = val.widget;
-		if (val.connections.empty()) continue;
+	for (auto &[coords, widget]: connectionWidgets) {
+		const auto &connections = boardStorage.connections.at(coords).connections;
+		if (connections.empty()) continue;
 		if (!widget) continue;
 		widget->state.parent = this;
 		widget->state.root = state.root;
@@ -392,18 +421,17 @@ void BoardView::Impl::arrangeChildren(squi::vec2 &pos) {
 void BoardView::Impl::drawChildren() {
 	auto &instance = Window::of(this).engine.instance;
 	instance.pushScissor(getRect());
-	const auto _ = {boardStorage.lines, boardStorage.elements};
-	for (const auto &line: _ | std::views::join) {
-		const auto &widget = line.widget;
+	const auto _ = {lineWidgets, elementWidgets};
+	for (const auto &[id, widget]: _ | std::views::join) {
 		if (!widget) continue;
 		widget->state.parent = this;
 		widget->state.root = state.root;
 		widget->draw();
 	}
-	for (auto &[key, val]: boardStorage.connections) {
-		auto &widget = val.widget;
-		if (val.connections.empty()) continue;
-		if (val.connections.size() == 2) continue;
+	for (auto &[coords, widget]: connectionWidgets) {
+		const auto &connections = boardStorage.connections.at(coords).connections;
+		if (connections.empty()) continue;
+		if (connections.size() == 2) continue;
 		if (!widget) continue;
 		widget->state.parent = this;
 		widget->state.root = state.root;
@@ -436,13 +464,11 @@ void BoardView::Impl::clickElement(squi::GestureDetector::Event /*event*/) {
 		};
 		addChild(selectedLineWidget.value());
 	} else if (
-		auto itLine = boardStorage.lineTiles.find(roundedGridPos);
-		itLine != boardStorage.lineTiles.end() && !itLine->second.empty()
+		const auto lineIds = boardStorage.lineSegments.at(roundedGridPos);
+		!lineIds.empty()
 	) {
-		for (auto &id: itLine->second) {
-			auto line = boardStorage.getLine(id);
-			const auto &widget = line->get().widget;
-			widget->customState.get<StateObservable>().notify(ElementState::selected);
+		for (const auto &id: lineIds) {
+			lineWidgets.at(id)->customState.get<StateObservable>().notify(ElementState::selected);
 			selectedWidgets.insert(id);
 		}
 	} else if (
@@ -455,11 +481,11 @@ void BoardView::Impl::clickElement(squi::GestureDetector::Event /*event*/) {
 			const auto it = selectedWidgets.find(id);
 			if (it == selectedWidgets.end()) {
 				// If the element wasn't selected then select it
-				closestElement->get().widget->customState.get<StateObservable>().notify(ElementState::selected);
+				elementWidgets.at(id)->customState.get<StateObservable>().notify(ElementState::selected);
 				selectedWidgets.insert(id);
 			} else {
 				// Otherwise unselect it
-				closestElement->get().widget->customState.get<StateObservable>().notify(ElementState::unselected);
+				elementWidgets.at(id)->customState.get<StateObservable>().notify(ElementState::unselected);
 				selectedWidgets.erase(it);
 			}
 		}
@@ -478,13 +504,8 @@ void BoardView::Impl::unselectAll() {
 		selectedLineWidget.reset();
 	}
 	for (const auto &id: selectedWidgets) {
-		auto elem = boardStorage.getElement(id);
-		auto line = boardStorage.getLine(id);
-		if (!elem.has_value() && !line.has_value()) continue;
-		auto widget = std::invoke([&]() {
-			if (elem.has_value()) return elem->get().widget;
-			return line->get().widget;
-		});
+		auto widget = widgetOf(id);
+		if (!widget) continue;
 		widget->customState.get<StateObservable>().notify(ElementState::unselected);
 	}
 	selectedWidgets.clear();
@@ -495,18 +516,126 @@ void BoardView::Impl::deleteSelected() {
 		hideResults();
 	}
 	for (const auto &id: selectedWidgets) {
-		auto elem = boardStorage.getElement(id);
-		auto line = boardStorage.getLine(id);
-		if (!elem.has_value() && !line.has_value()) continue;
-		auto widget = std::invoke([&]() {
-			if (elem.has_value()) return elem->get().widget;
-			return line->get().widget;
-		});
+		auto widget = widgetOf(id);
+		if (!widget) continue;
 		widget->customState.get<StateObservable>().notify(ElementState::removed);
 	}
 	selectedWidgets.clear();
 }
 
+void BoardView::Impl::startSimulation(SimulationType type) {
+	job = std::make_unique<SimulationJob>();
+	job->thread = std::jthread([this, type, &current = *job, board = std::make_shared<BoardStorage>(boardStorage.snapshot())](const std::stop_token &stopToken) {
+		auto &progress = *current.progress;
+		progress.stopToken = stopToken;
+
+		current.deliver = std::invoke([&]() -> std::function<void(Impl &)> {
+			auto graph = std::make_shared<const GraphDescriptor>(*board, &ThreadPool::shared());
+			if (progress.cancelled()) return {};
+
+			switch (type) {
+				case SimulationType::acSim: {
+					constexpr float frequency = 50.f;
+					auto simulation = resultCache.ac(*graph, frequency, [&] {
+						return ACSimulation{*graph, acSystem, frequency, &progress};
+					});
+					return [graph, board, simulation = std::move(simulation)](Impl &self) {
+						self.showResults(*board, *graph, ACResultsViewer{
+							.graph = *graph,
+							.board = *board,
+							.simulation = simulation,
+							.elementSelector = self.elementSelector,
+						});
+					};
+				}
+				case SimulationType::acSweep: {
+					auto simulation = ACSweep{*graph, sweepSettings, acSystem, &progress};
+					return [graph, board, simulation = std::move(simulation)](Impl &self) {
+						self.showResults(*board, *graph, ACSweepResultsViewer{
+							.graph = *graph,
+							.board = *board,
+							.simulation = simulation,
+							.elementSelector = self.elementSelector,
+						});
+					};
+				}
+				case SimulationType::transientSim: {
+					auto simulation = TransientSimulation{*graph, transientSettings, transientSystem, &progress};
+					return [graph, board, simulation = std::move(simulation)](Impl &self) {
+						self.showResults(*board, *graph, TransientResultsViewer{
+							.graph = *graph,
+							.board = *board,
+							.simulation = simulation,
+							.elementSelector = self.elementSelector,
+						});
+					};
+				}
+				case SimulationType::monteCarlo: {
+					auto simulation = MonteCarlo{*graph, monteCarloSettings, dcSystem, acSystem, &progress};
+					return [graph, board, simulation = std::move(simulation)](Impl &self) {
+						self.showResults(*board, *graph, MonteCarloResultsViewer{
+							.graph = *graph,
+							.board = *board,
+							.simulation = simulation,
+							.elementSelector = self.elementSelector,
+						});
+					};
+				}
+				case SimulationType::dcSim: {
+					auto simulation = resultCache.dc(*graph, [&] {
+						return DCSimulation{*graph, dcSystem, &progress};
+					});
+					return [graph, board, simulation = std::move(simulation)](Impl &self) {
+						self.showResults(*board, *graph, DCResultsViewer{
+							.graph = *graph,
+							.board = *board,
+							.simulation = simulation,
+							.elementSelector = self.elementSelector,
+						});
+					};
+				}
+			}
+			return {};
+		});
+
+		progress.stage = SimulationProgress::Stage::done;
+		// Wakes up the UI thread in case it is waiting for events
+		glfwPostEmptyEvent();
+	});
+
+	resultsAdder.notify(ResultsDisplay{
+		.destroyObs = resultsDestroyer,
+		.child = SimulationProgressViewer{
+			.progress = job->progress,
+			.onCancel = [this]() {
+				hideResults();
+			},
+		},
+	});
+}
+
+void BoardView::Impl::showResults(const BoardStorage &board, const GraphDescriptor &graph, const squi::Child &viewer) {
+	for (const auto &[index, elem]: graph.elements | std::views::enumerate) {
+		// The graph only keeps the netlist, the pins are placed from the board it was made from
+		const auto boardElement = board.getElement(elem.id);
+		if (!boardElement.has_value()) continue;
+		const auto &element = boardElement->get().element;
+		for (const auto &[nodeIndex, nodeCoords]: std::views::zip(graph.nodesOf(static_cast<size_t>(index)), element.nodes)) {
+			auto &_ = nodeIndexes.emplace_back(NodeIndexDisplay{
+				.nodeIndex = nodeIndex,
+				.pos = nodeCoords + element.pos,
+			});
+
+			addChild(_);
+		}
+	}
+
+	resultsAdder.notify(ResultsDisplay{
+		.destroyObs = resultsDestroyer,
+		.child = viewer,
+	});
+}
+
 void BoardView::Impl::clearNodeIndexes() {
 	for (const auto &nodeIndex: nodeIndexes) {
 		nodeIndex->deleteLater();
@@ -515,14 +644,16 @@ void BoardView::Impl::clearNodeIndexes() {
 }
 
 void BoardView::Impl::hideResults() {
+	// The progress of a running simulation is shown in place of the results, hiding it cancels the simulation
+	if (job) job->thread.request_stop();
 	clearNodeIndexes();
 	resultsDestroyer.notify();
 }
 
 BoardView::Impl::~Impl() {
-	for (const auto &comp: ComponentStore::components) {
-		const_cast<std::optional<Engine::SamplerUniform> &>(comp.get().texture).reset();
-		const_cast<std::optional<Engine::SamplerUniform> &>(comp.get().textureThumb).reset();
+	for (auto &textures: ComponentTextures::store()) {
+		textures.texture.reset();
+		textures.thumb.reset();
 	}
 }
 
@@ -7,14 +7,28 @@
 #include "components/capacitor.hpp"
 #include "components/inductor.hpp"
 #include "components/ground.hpp"
+#include "components/diode.hpp"
+#include "components/netLabel.hpp"
+#include "components/powerLabel.hpp"
 
-const std::vector<std::reference_wrapper<const Component>> ComponentStore::components{
-    conductor,
-    node,
-    voltageSource,
-    currentSource,
-    resistor,
-    ground,
-    capacitor,
-    inductor,
-};
\ No newline at end of file
+const std::vector<std::reference_wrapper<const Component>> ComponentStore::components = [] {
+    std::vector<std::reference_wrapper<const Component>> ret{
+        conductor,
+        node,
+        voltageSource,
+        currentSource,
+        resistor,
+        ground,
+        capacitor,
+        inductor,
+        diode,
+        netLabel,
+        powerLabel,
+    };
+    // The id of a component is its index here, save files and simulations refer to components by it
+    uint32_t idCounter = 0;
+    for (const auto &comp: ret) {
+        const_cast<uint32_t &>(comp.get().id) = idCounter++;
+    }
+    return ret;
+}();
\ No newline at end of file
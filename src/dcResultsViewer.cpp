@@ -16,21 +16,45 @@ DCResultsViewer::operator squi::Child() const {
 		.spacing = 4.f,
 		.children = [&]() -> Children {
 			Children ret{};
+			if (simulation.strategy != DCSimulation::Strategy::linear) {
+				ret.emplace_back(ResultsCard{
+					.title = "Operating point",
+					.columns{"Strategy", "Iterations", "Converged"},
+					.children{
+						ResultsItem{
+							.items{
+								std::invoke([&]() -> std::string_view {
+									switch (simulation.strategy) {
+										case DCSimulation::Strategy::linear:
+											return "Linear";
+										case DCSimulation::Strategy::newton:
+											return "Newton-Raphson";
+										case DCSimulation::Strategy::gminStepping:
+											return "Gmin stepping";
+										case DCSimulation::Strategy::sourceStepping:
+											return "Source stepping";
+									}
+									return "";
+								}),
+								std::format("{}", simulation.iterations),
+								simulation.converged ? "Yes" : "No",
+							},
+						},
+					},
+				});
+			}
+
 			if (!simulation.voltages.empty()) {
 				Children voltRet{};
 				for (const auto &[index, val]: simulation.voltages | std::views::enumerate) {
+					const auto nodeLines = graph.linesAt(static_cast<uint32_t>(index + 1));
 					voltRet.emplace_back(ResultsItem{
 						.items{
 							std::format("Node #{}", index + 1),
 							std::format("{:.2f}V", val),
 						},
-						.onClick = [elementSelector = elementSelector, node = graph.nodes.at(index + 1)]() {
-							std::vector<ElementId> ret{};
-							ret.reserve(node.lines.size());
-							for (const auto &line: node.lines) {
-								ret.emplace_back(line.id);
-							}
-							elementSelector.notify(ret);
+						.onClick = [elementSelector = elementSelector, lines = std::vector<ElementId>{nodeLines.begin(), nodeLines.end()}]() {
+							elementSelector.notify(lines);
 						},
 					});
 				}
@@ -1,139 +1,237 @@
 #include "dcSimulation.hpp"
-#include "ranges"
+#include "mnaSystem.hpp"
+#include "numbers"
+
+static constexpr double thermalVoltage = 0.025852;
+// Conductance always kept across every junction so a reverse biased diode doesn't leave a node floating
+static constexpr double junctionGmin = 1e-12;
+static constexpr double relTol = 1e-3;
+static constexpr double voltageTol = 1e-6;
+static constexpr double currentTol = 1e-12;
+static constexpr uint32_t maxIterations = 100;
+
+struct DiodeModel {
+	size_t index;
+	double saturationCurrent;
+	// Emission coefficient * thermal voltage
+	double emissionVoltage;
+	// Voltage where the exponential starts to bend sharply, the limiting only kicks in above it
+	double criticalVoltage;
+	double voltage;
+
+	[[nodiscard]] double current(double v) const {
+		return saturationCurrent * (std::exp(v / emissionVoltage) - 1.0);
+	}
 
-DCSimulation::DCSimulation(const GraphDescriptor &graph) {
-	if (graph.nodes.size() < 2) return;
-	auto incidenceMatrix = generateIncidenceMatrix(graph);
-	auto A = Eigen::MatrixXf(incidenceMatrix.bottomRows(incidenceMatrix.rows() - 1));
-	auto [mat, piv] = Utils::calculateNonzeroPivots(A);
-	auto Ar = Eigen::MatrixXf(A(Eigen::all, piv));
-	std::vector<int64_t> indices = [&]() {
-		auto temp = Eigen::Vector<int64_t, Eigen::Dynamic>::LinSpaced(mat.cols(), 0, mat.cols() - 1);
-		return std::vector<int64_t>(temp.begin(), temp.end());
-	}();
-	indices.erase(std::remove_if(indices.begin(), indices.end(), [&](const int &val) mutable -> bool {
-					  auto res = std::equal_range(piv.begin(), piv.end(), val);
-					  return res.first != res.second;
-				  }),
-				  indices.end());
-	auto Ac = A(Eigen::all, indices);
-
-	auto D = Ar.inverse() * Ac;
-
-	auto Br = Eigen::MatrixXf(-D.transpose());
-	auto Bc = Eigen::MatrixXf::Identity(Br.rows(), Br.rows());
-
-	auto B = Eigen::MatrixXf(Br.rows(), Br.cols() + Bc.cols());
-	B << Br, Bc;
-
-	std::vector<int64_t> Lp{};
-	std::vector<int64_t> Le{};
-	std::vector<int64_t> Lj{};
-	std::vector<ElementId> voltageSourceIds{};
-	for (const auto &[index, elem]: graph.elements | std::views::enumerate) {
-		const auto id = elem.second.element.component.get().id;
-		if (id == 2) {
-			Le.emplace_back(index);
-			voltageSourceIds.emplace_back(elem.second.element.id);
-		} else if (id == 3) {
-			Lj.emplace_back(index);
-		} else {
-			Lp.emplace_back(index);
+	[[nodiscard]] double conductance(double v) const {
+		return saturationCurrent / emissionVoltage * std::exp(v / emissionVoltage);
+	}
+
+	// Junction voltage limiting (as in SPICE's pnjlim), keeps a Newton step from jumping far up the exponential
+	[[nodiscard]] double limit(double newVoltage) const {
+		if (newVoltage <= criticalVoltage || std::abs(newVoltage - voltage) <= 2.0 * emissionVoltage) return newVoltage;
+		if (voltage > 0.0) {
+			const auto arg = 1.0 + (newVoltage - voltage) / emissionVoltage;
+			return arg > 0.0 ? voltage + emissionVoltage * std::log(arg) : criticalVoltage;
 		}
+		return emissionVoltage * std::log(newVoltage / emissionVoltage);
 	}
+};
 
-	auto Ap = A(Eigen::all, Lp);
-	auto Ae = A(Eigen::all, Le);
-	auto Aj = A(Eigen::all, Lj);
+DCSimulation::DCSimulation(const GraphDescriptor &graph) {
+	std::optional<MnaSystem<double>> system{};
+	*this = DCSimulation(graph, system);
+}
 
-	auto Bp = B(Eigen::all, Lp);
-	auto Be = B(Eigen::all, Le);
-	auto Bj = B(Eigen::all, Lj);
+DCSimulation::DCSimulation(const GraphDescriptor &graph, std::optional<MnaSystem<double>> &system, SimulationProgress *progress, MnaRefactor refactor) {
+	if (graph.nodeCount < 2) return;
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::assembly)) return;
+	MnaTopology newTopology{graph, MnaTopology::Analysis::dc};
+	// Only redo the symbolic analysis when the circuit topology changed
+	if (!system.has_value() || system->topology().hash() != newTopology.hash() || system->topology() != newTopology) {
+		system.emplace(std::move(newTopology));
+	}
+	const auto &topology = system->topology();
+	if (!topology.floatingNodes.empty()) {
+		std::println("Node {} is fed by a current source but has no D.C. path to ground", topology.floatingNodes.front());
+		return;
+	}
+	if (!topology.shortedInductors.empty()) {
+		std::println("Inductor #{} is across a voltage source or closes a loop of inductors, its D.C. current isn't defined", topology.shortedInductors.front());
+		return;
+	}
 
-	auto params = Eigen::VectorXf(graph.elements.size());
-	int64_t paramIndex = 0;
-	for (const auto &[index, elem]: graph.elements | std::views::enumerate) {
-		const auto &element = elem.second.element;
-		const auto id = elem.second.element.component.get().id;
+	std::vector<double> params{};
+	std::vector<DiodeModel> diodes{};
+	params.reserve(topology.branches.size());
+	for (const auto &[index, element]: graph.elements | std::views::enumerate) {
+		const auto id = element.component.get().id;
 		if (id == 2) {
 			// Voltage source
 			if (element.propertySetIndex == 1) {
-				params(paramIndex++) = 0;
+				params.emplace_back(0.0);
 				continue;
 			}
-			params(paramIndex++) = getFloat(element.propertiesValues.at(0));
+			params.emplace_back(graph.value(index, 0));
 		} else if (id == 3) {
 			// Current source
 			if (element.propertySetIndex == 1) {
-				params(paramIndex++) = 0;
+				params.emplace_back(0.0);
 				continue;
 			}
-			params(paramIndex++) = getFloat(element.propertiesValues.at(0));
+			params.emplace_back(graph.value(index, 0));
 		} else if (id == 4) {
 			// Resistor
-			params(paramIndex++) = getFloat(element.propertiesValues.at(0));
+			params.emplace_back(1.0 / graph.value(index, 0));
 		} else if (id == 6) {
-			// Capacitor
-			params(paramIndex++) = std::numeric_limits<float>::max();
+			// Capacitor, an open circuit that isn't stamped
+			params.emplace_back(0.0);
 		} else if (id == 7) {
-			// Inductor
-			params(paramIndex++) = std::numeric_limits<float>::min();
+			// Inductor, a 0V source
+			params.emplace_back(0.0);
+		} else if (id == 8) {
+			// Diode, the conductance is filled in by every Newton iteration
+			const double saturationCurrent = graph.value(index, 0);
+			const double emissionCoefficient = graph.value(index, 1);
+			// The exponential and the critical voltage only make sense for positive values, NaNs fail here too
+			if (!(saturationCurrent > 0.0) || !(emissionCoefficient > 0.0)) {
+				std::println("Diode #{} needs a positive saturation current and emission coefficient", element.id);
+				return;
+			}
+			const auto emissionVoltage = emissionCoefficient * thermalVoltage;
+			const auto criticalVoltage = emissionVoltage * std::log(emissionVoltage / (std::numbers::sqrt2 * saturationCurrent));
+			diodes.emplace_back(DiodeModel{
+				.index = params.size(),
+				.saturationCurrent = saturationCurrent,
+				.emissionVoltage = emissionVoltage,
+				.criticalVoltage = criticalVoltage,
+				// Every junction starts at its critical voltage (like in SPICE), at 0V a diode barely conducts
+				// and whole parts of the circuit would start out as floating
+				.voltage = criticalVoltage,
+			});
+			params.emplace_back(0.0);
 		}
 	}
-	auto R = Eigen::MatrixXf(params(Lp).asDiagonal());
-	auto E = params(Le).transpose();
-	auto J = params(Lj).transpose();
-
-	auto G = R.inverse();
-	auto temp1 = Ap * G * Ap.transpose();
-
-	auto Pb = Eigen::MatrixXf(temp1.rows() + Le.size(), temp1.cols() + Ae.cols());
-	Pb << temp1,
-		Ae,
-		Ae.transpose(),
-		Eigen::MatrixXf::Zero(static_cast<int64_t>(Le.size()), static_cast<int64_t>(Le.size()));
-
-	Eigen::MatrixXf Qb;
-	if (J.size() != 0) {
-		auto _ = Aj * J;
-		Qb.resize(_.rows() + E.rows(), _.cols());
-		Qb << -_, -E;
+
+	const auto nodeCount = static_cast<int64_t>(topology.nodeCount) - 1;
+	std::optional<MnaSystem<double>::Vector> solution{};
+	if (diodes.empty()) {
+		iterations = 1;
+		if (!SimulationProgress::report(progress, SimulationProgress::Stage::factorization)) return;
+		if (!system->factorize(params, refactor)) return;
+		if (!SimulationProgress::report(progress, SimulationProgress::Stage::solve)) return;
+		solution = system->solve();
 	} else {
-		Qb.resize(static_cast<int64_t>(graph.nodes.size() - 1) + E.rows(), 1);
-		Qb << -Eigen::MatrixXf::Zero(static_cast<int64_t>(graph.nodes.size() - 1), 1), -E;
+		const auto sourceValues = params;
+		const auto nodeVoltage = [&](const MnaSystem<double>::Vector &vec, uint32_t node) {
+			return node == 0 ? 0.0 : vec(node - 1);
+		};
+
+		// Every iteration reuses the symbolic analysis of the system, only the numeric factorization is redone
+		const auto newton = [&](double sourceScale, double shunt) {
+			MnaSystem<double>::Vector previous = solution.value_or(MnaSystem<double>::Vector::Zero(topology.size()));
+			for (uint32_t iteration = 0; iteration < maxIterations; iteration++) {
+				iterations++;
+				for (const auto &[index, branch]: topology.branches | std::views::enumerate) {
+					if (branch.type == MnaBranch::Type::admittance) continue;
+					params.at(index) = sourceScale * sourceValues.at(index);
+				}
+				for (const auto &diode: diodes) {
+					params.at(diode.index) = diode.conductance(diode.voltage) + junctionGmin;
+				}
+				if (!SimulationProgress::report(progress, SimulationProgress::Stage::factorization)) return false;
+				if (!system->refactor(params, shunt)) return false;
+
+				// Linearized diode: i = g * v + (i0 - g * v0), the constant part acts as a current source
+				auto rhs = system->sourceVector(params);
+				for (const auto &diode: diodes) {
+					const auto &branch = topology.branches.at(diode.index);
+					const auto equivalent = diode.current(diode.voltage) - diode.conductance(diode.voltage) * diode.voltage;
+					if (branch.nodeA != 0) rhs(branch.nodeA - 1) -= equivalent;
+					if (branch.nodeB != 0) rhs(branch.nodeB - 1) += equivalent;
+				}
+
+				if (!SimulationProgress::report(progress, SimulationProgress::Stage::solve)) return false;
+				auto next = system->solve(rhs);
+				if (!next.has_value()) return false;
+
+				bool done = iteration > 0;
+				for (int64_t i = 0; i < nodeCount && done; i++) {
+					const auto tolerance = relTol * std::max(std::abs((*next)(i)), std::abs(previous(i))) + voltageTol;
+					done = std::abs((*next)(i) - previous(i)) <= tolerance;
+				}
+				for (auto &diode: diodes) {
+					const auto &branch = topology.branches.at(diode.index);
+					const auto newVoltage = nodeVoltage(*next, branch.nodeA) - nodeVoltage(*next, branch.nodeB);
+					// The current predicted by the linearization has to match the real one at the new voltage
+					const auto predicted = diode.current(diode.voltage) + diode.conductance(diode.voltage) * (newVoltage - diode.voltage);
+					const auto actual = diode.current(newVoltage);
+					done = done && std::abs(predicted - actual) <= relTol * std::max(std::abs(predicted), std::abs(actual)) + currentTol;
+
+					const auto limited = diode.limit(newVoltage);
+					done = done && limited == newVoltage;
+					diode.voltage = limited;
+				}
+
+				previous = std::move(*next);
+				if (done) {
+					solution = previous;
+					return true;
+				}
+			}
+			return false;
+		};
+		const auto cancelled = [&]() {
+			return progress && progress->cancelled();
+		};
+		const auto reset = [&]() {
+			solution.reset();
+			for (auto &diode: diodes) diode.voltage = diode.criticalVoltage;
+		};
+
+		strategy = Strategy::newton;
+		converged = newton(1.0, 0.0);
+		if (!converged && !cancelled()) {
+			strategy = Strategy::gminStepping;
+			reset();
+			converged = true;
+			for (double shunt = 1e-2; shunt > 1e-12 && converged; shunt /= 10.0) {
+				converged = newton(1.0, shunt);
+			}
+			converged = converged && newton(1.0, 0.0);
+		}
+		if (!converged && !cancelled()) {
+			strategy = Strategy::sourceStepping;
+			reset();
+			converged = true;
+			for (uint32_t step = 1; step <= 10 && converged; step++) {
+				converged = newton(static_cast<double>(step) / 10.0, 0.0);
+			}
+		}
+		if (cancelled()) {
+			converged = false;
+			return;
+		}
+		if (!converged) {
+			std::println("The D.C. operating point didn't converge after {} Newton-Raphson iterations", iterations);
+			return;
+		}
 	}
+	if (!solution.has_value()) return;
+	converged = true;
 
-	auto Xb = Pb.inverse() * Qb;
-
-	auto V_numeric = Xb.topRows(graph.nodes.size() - 1).eval();
-	auto Ie_numeric_b = Xb.bottomRows(Xb.rows() - (graph.nodes.size() - 1)).eval();
-	std::println("V_numeric");
-	std::cout << V_numeric << std::endl;
-	std::println("Ie_numeric_b");
-	std::cout << Ie_numeric_b << std::endl;
-
-	currents.reserve(Ie_numeric_b.rows());
-	for (const auto &[val, id]: std::views::zip(Ie_numeric_b.reshaped(), voltageSourceIds)) {
-		currents.emplace_back(id, val);
+	voltages.reserve(nodeCount);
+	for (const auto &val: solution->head(nodeCount)) {
+		voltages.emplace_back(static_cast<float>(val));
 	}
 
-	voltages.reserve(V_numeric.rows());
-	for (auto &val: V_numeric.reshaped()) {
-		voltages.emplace_back(val);
+	currents.reserve(topology.voltageSourceCount + diodes.size());
+	int64_t sourceIndex = nodeCount;
+	for (const auto &branch: topology.branches) {
+		if (branch.type != MnaBranch::Type::voltageSource) continue;
+		currents.emplace_back(branch.id, static_cast<float>((*solution)(sourceIndex++)));
 	}
-}
-
-Eigen::MatrixXf DCSimulation::generateIncidenceMatrix(const GraphDescriptor &graph) {
-	Eigen::MatrixXf ret{};
-	ret.resize(
-		static_cast<int64_t>(graph.nodes.size()),
-		static_cast<int64_t>(graph.elements.size())
-	);
-	ret.fill(0);
-	for (const auto &[index, elem]: graph.elements | std::views::enumerate) {
-		ret.col(index)(elem.second.nodes.at(0)) = 1;
-		ret.col(index)(elem.second.nodes.at(1)) = -1;
+	for (const auto &diode: diodes) {
+		currents.emplace_back(topology.branches.at(diode.index).id, static_cast<float>(diode.current(diode.voltage) + junctionGmin * diode.voltage));
 	}
-
-	return ret;
 }
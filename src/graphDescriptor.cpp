@@ -1,205 +1,245 @@
 #include "graphDescriptor.hpp"
-#include "boardLine.hpp"
 #include "element.hpp"
+#include "threadPool.hpp"
 #include <algorithm>
 #include <chrono>
-#include <functional>
+#include <limits>
 #include <optional>
 #include <print>
 #include <queue>
 #include <ranges>
+#include <span>
+#include <sstream>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
-GraphDescriptor::GraphDescriptor(BoardStorage &board) {
-	exploreBoard(board);
+GraphDescriptor::GraphDescriptor(BoardStorage &board, ThreadPool *pool) {
+	exploreBoard(board, pool);
 }
 
-std::vector<Connection> getAdditionalConnections(const BoardStorage &board, const Coords &coords, const std::vector<Connection> &connections) {
-	std::vector<Connection> additionalConnections{};
-	if (!board.lineTiles.contains(coords)) return additionalConnections;
-	const auto &lines = board.lineTiles.at(coords);
-	for (const auto &lineId: lines) {
-		bool hasLine = false;
-		for (const auto &connection: connections) {
-			if (connection.elementId == lineId) {
-				hasLine = true;
-				break;
-			}
-		}
-		if (!hasLine) {
-			auto lineIt = board.getLine(lineId);
-			if (!lineIt.has_value()) continue;
-			for (const auto &[nodeIndex, _]: lineIt->get().element.nodes | std::views::enumerate) {
-				additionalConnections.emplace_back(Connection{
-					.nodeIndex = static_cast<size_t>(nodeIndex),
-					.elementId = lineId,
-				});
-			}
-		}
-	}
-
-	return additionalConnections;
-}
+void GraphDescriptor::exploreBoard(BoardStorage &board, ThreadPool *pool) {
+	if (board.elements.empty()) return;
+	auto startTime = std::chrono::steady_clock::now();
 
-GraphDescriptor::ExpandNodeResult GraphDescriptor::expandNode(
-	size_t nodeIndex,
-	const Coords &coords,
-	ExplorationState &state
-) {
-	ExpandArgs args{
-		.nodeIndex = nodeIndex,
-		.state = state,
-		.self = *this,
+	// The board keeps its nets up to date as it's edited, they only need a dense index here
+	std::unordered_map<NetId, uint32_t> netIndices{};
+	netIndices.reserve(board.nets.netPoints.size());
+	for (const auto &[net, _]: board.nets.netPoints) {
+		netIndices.emplace(net, static_cast<uint32_t>(netIndices.size()));
+	}
+	const auto netAt = [&](const Coords &point) {
+		return netIndices.at(board.nets.pointNets.at(point).net);
 	};
 
-	auto crawler = [](this auto &&self, ExpandArgs &args, const Coords &coords) -> void {
-		if (args.state.exploredConnections.contains(coords)) return;
-		args.state.exploredConnections.emplace(coords);
-
-		const auto connections = {
-			args.state.board.connections.at(coords).connections,
-			getAdditionalConnections(
-				args.state.board,
-				coords,
-				args.state.board.connections.at(coords).connections
-			),
-		};
-
-		for (const auto &connection: std::views::join(connections)) {
-			const Element &elemData = std::invoke([&]() -> const Element & {
-				if (auto _ = args.state.board.getElement(connection.elementId); _.has_value()) return _->get().element;
-				return args.state.board.getLine(connection.elementId)->get().element;
-			});
-
-			const auto elemType = elemData.component.get().type;
-			switch (elemType) {
-				case ElementType::Other: {
-					args.ret.elements.emplace_back(elemData);
-
-					// Set the element connection to the current node
-					auto [it, _] = args.self.elements.emplace(elemData.id, GraphElement{.element{elemData}});
-					it->second.nodes.at(connection.nodeIndex) = args.state.nodeIdCounter;
-
-					continue;
-				}
-				case ElementType::Ground:
-				case ElementType::Line: {
-					if (args.locallyExploredLines.contains(elemData.id)) {
-						continue;
-					}
-					args.locallyExploredLines.emplace(elemData.id);
-					args.ret.lines.emplace_back(elemData);
-
-					std::vector<Coords> connectionCoords{};
-					if (elemType == ElementType::Line) {
-						const auto dist = (elemData.nodes.at(0) - elemData.nodes.at(1)).abs();
-						// Go along all the points on the line
-						// If any connections are found then add them to the list
-						// This will catch any straggler connections that are attached to the middle of the line
-						for (auto x: std::views::iota(elemData.pos.x) | std::views::take(dist.x + 1)) {
-							for (auto y: std::views::iota(elemData.pos.y) | std::views::take(dist.y + 1)) {
-								if (args.state.board.connections.contains(Coords{x, y}) && args.state.board.connections.at(Coords{x, y}).connections.size() > 0)
-									connectionCoords.emplace_back(Coords{x, y});
-							}
-						}
-					} else if (elemType == ElementType::Ground) {
-						for (const auto &elem: args.state.board.elements) {
-							if (elem.element.component.get().type != ElementType::Ground) continue;
-							for (const auto &node: elem.element.nodes) {
-								connectionCoords.emplace_back(node + elem.element.pos);
-							}
-						}
-					}
-
-					for (const auto &connectionCoord: connectionCoords) {
-						if (connectionCoord == coords) continue;
-
-						self(args, connectionCoord);
-					}
-				}
+	// Net of every pin, the pins of board element i start at boardPinOffsets[i]
+	std::vector<uint32_t> boardPinOffsets{};
+	boardPinOffsets.reserve(board.elements.size() + 1);
+	std::optional<uint32_t> groundIndex{};
+	uint32_t pinCount = 0;
+	for (const auto &[elemIndex, elem]: board.elements | std::views::enumerate) {
+		boardPinOffsets.emplace_back(pinCount);
+		pinCount += static_cast<uint32_t>(elem.element.nodes.size());
+		if (!groundIndex.has_value() && elem.element.component.get().type == ElementType::Ground) groundIndex = static_cast<uint32_t>(elemIndex);
+	}
+	boardPinOffsets.emplace_back(pinCount);
+	// The lookups only read the board, so the elements are split into chunks that every thread of the pool resolves on its own
+	std::vector<uint32_t> pinNets(pinCount);
+	static constexpr size_t chunkSize = 4096;
+	const auto resolveChunk = [&](size_t, size_t chunk) {
+		const auto end = std::min(board.elements.size(), (chunk + 1) * chunkSize);
+		for (auto elemIndex = chunk * chunkSize; elemIndex < end; elemIndex++) {
+			const auto &elem = board.elements.at(elemIndex).element;
+			for (const auto &[pin, node]: elem.nodes | std::views::enumerate) {
+				pinNets.at(boardPinOffsets.at(elemIndex) + static_cast<size_t>(pin)) = netAt(node + elem.pos);
 			}
 		}
 	};
-	crawler(args, coords);
-
-	return args.ret;
-}
+	const auto chunkCount = (board.elements.size() + chunkSize - 1) / chunkSize;
+	if (pool != nullptr && chunkCount > 1) {
+		pool->parallelFor(chunkCount, resolveChunk);
+	} else {
+		for (size_t chunk = 0; chunk < chunkCount; chunk++) resolveChunk(0, chunk);
+	}
 
-void GraphDescriptor::exploreBoard(BoardStorage &board) {
-	if (board.elements.empty()) return;
-	auto startTime = std::chrono::steady_clock::now();
-	ExplorationState state{
-		.board = board,
+	// Elements attached to every net, the ones on net n start at netOffsets[n]
+	// An element with several pins on the same net is only listed once
+	const auto forEachNet = [&](size_t elemIndex, auto &&func) {
+		const auto begin = boardPinOffsets.at(elemIndex);
+		for (auto pin = begin; pin < boardPinOffsets.at(elemIndex + 1); pin++) {
+			if (std::find(pinNets.begin() + begin, pinNets.begin() + pin, pinNets.at(pin)) == pinNets.begin() + pin) func(pinNets.at(pin));
+		}
 	};
+	std::vector<uint32_t> netOffsets(netIndices.size() + 1, 0);
+	for (const auto &[elemIndex, elem]: board.elements | std::views::enumerate) {
+		if (elem.element.component.get().type != ElementType::Other) continue;
+		forEachNet(elemIndex, [&](uint32_t net) {
+			netOffsets.at(net + 1)++;
+		});
+	}
+	for (size_t i = 1; i < netOffsets.size(); i++) {
+		netOffsets.at(i) += netOffsets.at(i - 1);
+	}
+	std::vector<uint32_t> netElements(netOffsets.back());
+	std::vector<uint32_t> netFill{netOffsets.begin(), netOffsets.end() - 1};
+	for (const auto &[elemIndex, elem]: board.elements | std::views::enumerate) {
+		if (elem.element.component.get().type != ElementType::Other) continue;
+		forEachNet(elemIndex, [&](uint32_t net) {
+			netElements.at(netFill.at(net)++) = static_cast<uint32_t>(elemIndex);
+		});
+	}
 
-	// Will add the first ground element to the traverseQueue
+	// Number the nets in the order they are reached from the first ground element,
 	// this is to ensure that the ground node always gets index 0
-	auto groundIt = std::find_if(
-		board.elements.begin(),
-		board.elements.end(),
-		[](const ElementData &elem) {
-			return elem.element.component.get().type == ElementType::Ground;
-		}
-	);
-
-	std::queue<std::reference_wrapper<const Element>> traverseQueue{};
-	traverseQueue.emplace(
-		groundIt == board.elements.end()
-			? board.elements.front().element
-			: groundIt->element
-	);
+	// Nets that can't be reached from there are left out
+	static constexpr auto unnumbered = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> netIds(netIndices.size(), unnumbered);
+	std::vector<bool> queuedElements(board.elements.size(), false);
+	std::queue<uint32_t> traverseQueue{};
+	traverseQueue.emplace(groundIndex.value_or(0));
+	queuedElements.at(groundIndex.value_or(0)) = true;
+	// Elements that are part of the circuit, as indices into the board
+	std::vector<uint32_t> simulated{};
 
 	while (!traverseQueue.empty()) {
-		const auto &elem = traverseQueue.front().get();
+		const auto elemIndex = traverseQueue.front();
 		traverseQueue.pop();
 
-		for (const auto &[index, node]: elem.nodes | std::views::enumerate) {
-			const auto coords = node + elem.pos;
-			if (state.exploredConnections.contains(coords)) continue;
+		// Every element is only queued once
+		if (board.elements.at(elemIndex).element.component.get().type == ElementType::Other) simulated.emplace_back(elemIndex);
 
-			auto res = expandNode(index, coords, state);
+		for (auto pin = boardPinOffsets.at(elemIndex); pin < boardPinOffsets.at(elemIndex + 1); pin++) {
+			const auto net = pinNets.at(pin);
+			if (netIds.at(net) != unnumbered) continue;
+			netIds.at(net) = nodeCount++;
 
-			for (auto &element: res.elements) {
-				traverseQueue.emplace(element);
+			for (auto i = netOffsets.at(net); i < netOffsets.at(net + 1); i++) {
+				const auto neighbourIndex = netElements.at(i);
+				if (queuedElements.at(neighbourIndex)) continue;
+				queuedElements.at(neighbourIndex) = true;
+				traverseQueue.emplace(neighbourIndex);
 			}
-			nodes.emplace(
-				state.nodeIdCounter++,
-				Node{
-					.elements{res.elements.begin(), res.elements.end()},
-					.lines{res.lines.begin(), res.lines.end()},
-				}
-			);
 		}
 	}
 
-
-	// Find the elements that have all their connections at the same node
-	std::vector<decltype(elements)::const_iterator> elemsToErase{};
-	for (auto it = elements.begin(); it != elements.end(); it++) {
-		if (std::ranges::adjacent_find(it->second.nodes, std::ranges::not_equal_to()) == it->second.nodes.end()) {
-			elemsToErase.emplace_back(it);
+	// Elements that have all their connections at the same node are left out
+	std::erase_if(simulated, [&](uint32_t elemIndex) {
+		const auto pins = std::span(pinNets).subspan(boardPinOffsets.at(elemIndex), boardPinOffsets.at(elemIndex + 1) - boardPinOffsets.at(elemIndex));
+		if (std::ranges::adjacent_find(pins, std::ranges::not_equal_to()) != pins.end()) return false;
+		const auto &elem = board.elements.at(elemIndex).element;
+		if (verbose) std::println("Note: {}{} ignored due to having all connections on the same node", elem.component.get().prefix, elem.id);
+		return true;
+	});
+	// The board keeps its elements sorted by id, so this leaves them sorted by component and then by id
+	std::ranges::stable_sort(simulated, {}, [&](uint32_t elemIndex) {
+		return board.elements.at(elemIndex).element.component.get().id;
+	});
+
+	elements.reserve(simulated.size());
+	pinOffsets.reserve(simulated.size() + 1);
+	pinNodes.reserve(simulated.size() * 2);
+	valueOffsets.reserve(simulated.size() + 1);
+	for (const auto &elemIndex: simulated) {
+		const auto &elem = board.elements.at(elemIndex).element;
+		const auto componentId = elem.component.get().id;
+		if (componentOffsets.size() <= componentId + 1) componentOffsets.resize(componentId + 2, static_cast<uint32_t>(elements.size()));
+		componentOffsets.at(componentId + 1) = static_cast<uint32_t>(elements.size() + 1);
+
+		elements.emplace_back(GraphElement{
+			.component = elem.component,
+			.id = elem.id,
+			.propertySetIndex = static_cast<uint32_t>(elem.propertySetIndex),
+		});
+		pinOffsets.emplace_back(static_cast<uint32_t>(pinNodes.size()));
+		for (auto pin = boardPinOffsets.at(elemIndex); pin < boardPinOffsets.at(elemIndex + 1); pin++) {
+			pinNodes.emplace_back(netIds.at(pinNets.at(pin)));
+		}
+		valueOffsets.emplace_back(static_cast<uint32_t>(values.size()));
+		for (const auto &property: elem.propertiesValues) {
+			const auto *number = std::get_if<NumberProperty>(&property);
+			values.emplace_back(Value{
+				.value = getFloat(property),
+				.tolerance = number ? number->tolerance : 0.f,
+				.distribution = number ? number->distribution : NumberProperty::Distribution::uniform,
+			});
 		}
 	}
+	pinOffsets.emplace_back(static_cast<uint32_t>(pinNodes.size()));
+	valueOffsets.emplace_back(static_cast<uint32_t>(values.size()));
 
-	auto endTime = std::chrono::steady_clock::now();
-	std::println("----------------");
-	
-	for (auto &it: elemsToErase) {
-		std::println("Note: {}{} ignored due to having all connections on the same node", it->second.element.component.get().prefix, it->second.element.id);
-		elements.erase(it);
+	indexNodes();
+
+	// Lines, grounds and labels are listed with the node they belong to
+	std::vector<std::pair<uint32_t, ElementId>> lines{};
+	lines.reserve(board.lines.size());
+	for (const auto &line: board.lines) {
+		const auto nodeId = netIds.at(netAt(line.element.pos + line.element.nodes.front()));
+		if (nodeId != unnumbered) lines.emplace_back(nodeId, line.element.id);
+	}
+	for (const auto &[elemIndex, elem]: board.elements | std::views::enumerate) {
+		if (elem.element.component.get().type == ElementType::Other) continue;
+		const auto nodeId = netIds.at(pinNets.at(boardPinOffsets.at(elemIndex)));
+		if (nodeId != unnumbered) lines.emplace_back(nodeId, elem.element.id);
+	}
+	// By node and then by id
+	std::ranges::sort(lines);
+	nodeLineOffsets.assign(nodeCount + 1, 0);
+	nodeLines.reserve(lines.size());
+	for (const auto &[nodeId, id]: lines) {
+		nodeLineOffsets.at(nodeId + 1)++;
+		nodeLines.emplace_back(id);
+	}
+	for (size_t i = 1; i < nodeLineOffsets.size(); i++) {
+		nodeLineOffsets.at(i) += nodeLineOffsets.at(i - 1);
 	}
 
+	auto endTime = std::chrono::steady_clock::now();
+	if (!verbose) return;
+	std::println("----------------");
 	std::println("Time taken: {}", endTime - startTime);
-	for (auto &[nodeId, node]: nodes) {
-		std::println("Node: {}, with {} lines and {} elements", nodeId, node.lines.size(), node.elements.size());
+	for (uint32_t node = 0; node < nodeCount; node++) {
+		std::println("Node: {}, with {} lines and {} elements", node, linesAt(node).size(), elementsAt(node).size());
 	}
-	for (const auto &[id, element]: elements) {
+	for (const auto &[index, element]: elements | std::views::enumerate) {
 		std::stringstream vectorNodeIds{};
-		for (const auto &node: element.nodes) {
+		for (const auto &node: nodesOf(static_cast<size_t>(index))) {
 			vectorNodeIds << "N" << node << " ";
 		}
-		std::println("{} #{} {}", element.element.component.get().name, element.element.id, vectorNodeIds.str());
+		std::println("{} #{} {}", element.component.get().name, element.id, vectorNodeIds.str());
+	}
+}
+
+std::optional<size_t> GraphDescriptor::indexOf(ElementId id) const {
+	// Every component's elements are sorted by id
+	for (size_t componentId = 0; componentId + 1 < componentOffsets.size(); componentId++) {
+		const auto range = std::span(elements).subspan(componentOffsets.at(componentId), componentOffsets.at(componentId + 1) - componentOffsets.at(componentId));
+		const auto it = std::ranges::lower_bound(range, id, {}, &GraphElement::id);
+		if (it != range.end() && it->id == id) return componentOffsets.at(componentId) + static_cast<size_t>(it - range.begin());
 	}
+	return std::nullopt;
 }
+
+void GraphDescriptor::indexNodes() {
+	// Counted first and then filled in
+	nodeElementOffsets.assign(nodeCount + 1, 0);
+	const auto forEachNode = [&](size_t index, auto &&func) {
+		const auto pins = nodesOf(index);
+		for (auto it = pins.begin(); it != pins.end(); it++) {
+			if (std::find(pins.begin(), it, *it) == it) func(*it);
+		}
+	};
+	for (size_t i = 0; i < elements.size(); i++) {
+		forEachNode(i, [&](uint32_t node) {
+			nodeElementOffsets.at(node + 1)++;
+		});
+	}
+	for (size_t i = 1; i < nodeElementOffsets.size(); i++) {
+		nodeElementOffsets.at(i) += nodeElementOffsets.at(i - 1);
+	}
+	nodeElements.resize(nodeElementOffsets.back());
+	std::vector<uint32_t> nodeFill{nodeElementOffsets.begin(), nodeElementOffsets.end() - 1};
+	for (size_t i = 0; i < elements.size(); i++) {
+		forEachNode(i, [&](uint32_t node) {
+			nodeElements.at(nodeFill.at(node)++) = static_cast<uint32_t>(i);
+		});
+	}
+}
\ No newline at end of file
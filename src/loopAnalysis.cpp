@@ -0,0 +1,109 @@
+#include "loopAnalysis.hpp"
+#include <limits>
+#include <queue>
+#include <ranges>
+
+LoopAnalysis::LoopAnalysis(const GraphDescriptor &graph) : elementCount(graph.elements.size()) {
+	static constexpr auto none = std::numeric_limits<uint32_t>::max();
+	// Tree branch that leads to every node from its parent, and how deep the node is in its tree
+	std::vector<uint32_t> parentElement(graph.nodeCount, none);
+	std::vector<uint32_t> parentNode(graph.nodeCount, none);
+	std::vector<uint32_t> depth(graph.nodeCount, 0);
+	std::vector<bool> visited(graph.nodeCount, false);
+	std::vector<uint32_t> treeIndex(graph.elements.size(), none);
+
+	// The ground is the root of the first tree, parts that aren't connected to it get trees of their own
+	std::queue<uint32_t> queue{};
+	for (uint32_t root = 0; root < graph.nodeCount; root++) {
+		if (visited[root]) continue;
+		visited[root] = true;
+		queue.emplace(root);
+		while (!queue.empty()) {
+			const auto node = queue.front();
+			queue.pop();
+			for (const auto &element: graph.elementsAt(node)) {
+				for (const auto &other: graph.nodesOf(element)) {
+					if (visited[other]) continue;
+					visited[other] = true;
+					parentElement[other] = element;
+					parentNode[other] = node;
+					depth[other] = depth[node] + 1;
+					treeIndex[element] = static_cast<uint32_t>(treeBranches.size());
+					treeBranches.emplace_back(element);
+					queue.emplace(other);
+				}
+			}
+		}
+	}
+
+	// +1 if the element goes from the node to its other end
+	const auto along = [&](uint32_t element, uint32_t from) {
+		return graph.nodesOf(element)[0] == from ? 1 : -1;
+	};
+	std::vector<Entry> descent{};
+	for (uint32_t element = 0; element < graph.elements.size(); element++) {
+		if (treeIndex[element] != none) continue;
+		const auto pins = graph.nodesOf(element);
+		chords.emplace_back(element);
+		loopEntries.emplace_back(Entry{element, 1});
+
+		// Both ends climb to their common ancestor, the path from the start of the chord is walked downwards so it is reversed
+		auto end = pins[1];
+		auto start = pins[0];
+		descent.clear();
+		while (end != start) {
+			if (depth[end] >= depth[start]) {
+				loopEntries.emplace_back(Entry{parentElement[end], along(parentElement[end], end)});
+				end = parentNode[end];
+			} else {
+				descent.emplace_back(Entry{parentElement[start], -along(parentElement[start], start)});
+				start = parentNode[start];
+			}
+		}
+		loopEntries.insert(loopEntries.end(), descent.rbegin(), descent.rend());
+		loopOffsets.emplace_back(static_cast<uint32_t>(loopEntries.size()));
+	}
+
+	// Q = [-Bt^T | I], so every cutset is the column of its branch in the loops with the signs flipped
+	cutsetOffsets.assign(treeBranches.size() + 1, 0);
+	for (size_t loopIndex = 0; loopIndex < chords.size(); loopIndex++) {
+		for (const auto &entry: loop(loopIndex).subspan(1)) {
+			cutsetOffsets[treeIndex[entry.element] + 1]++;
+		}
+	}
+	for (size_t i = 0; i < treeBranches.size(); i++) {
+		// The branch itself
+		cutsetOffsets[i + 1] += cutsetOffsets[i] + 1;
+	}
+	cutsetEntries.resize(cutsetOffsets.back());
+	std::vector<uint32_t> fill{cutsetOffsets.begin(), cutsetOffsets.end() - 1};
+	for (const auto &[index, element]: treeBranches | std::views::enumerate) {
+		cutsetEntries[fill[static_cast<size_t>(index)]++] = Entry{element, 1};
+	}
+	for (size_t loopIndex = 0; loopIndex < chords.size(); loopIndex++) {
+		for (const auto &entry: loop(loopIndex).subspan(1)) {
+			cutsetEntries[fill[treeIndex[entry.element]]++] = Entry{chords[loopIndex], -entry.sign};
+		}
+	}
+}
+
+Eigen::SparseMatrix<float> LoopAnalysis::loopMatrix() const {
+	return matrix(chords.size(), loopOffsets, loopEntries);
+}
+
+Eigen::SparseMatrix<float> LoopAnalysis::cutsetMatrix() const {
+	return matrix(treeBranches.size(), cutsetOffsets, cutsetEntries);
+}
+
+Eigen::SparseMatrix<float> LoopAnalysis::matrix(size_t rows, const std::vector<uint32_t> &offsets, const std::vector<Entry> &entries) const {
+	std::vector<Eigen::Triplet<float>> triplets{};
+	triplets.reserve(entries.size());
+	for (size_t row = 0; row < rows; row++) {
+		for (auto i = offsets[row]; i < offsets[row + 1]; i++) {
+			triplets.emplace_back(static_cast<int>(row), static_cast<int>(entries[i].element), static_cast<float>(entries[i].sign));
+		}
+	}
+	Eigen::SparseMatrix<float> ret(static_cast<int64_t>(rows), static_cast<int64_t>(elementCount));
+	ret.setFromTriplets(triplets.begin(), triplets.end());
+	return ret;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#include "mnaSystem.hpp"
+#include "disjointSet.hpp"
+#include "graphDescriptor.hpp"
+#include <ranges>
+
+MnaTopology::MnaTopology(const GraphDescriptor &graph, Analysis analysis)
+	: nodeCount(graph.nodeCount) {
+	const bool dc = analysis == Analysis::dc;
+	// Nodes joined by anything that carries a D.C. current, and nodes joined by voltage sources and inductors only
+	DisjointSet conducting{};
+	DisjointSet shorted{};
+	if (dc) {
+		conducting.reserve(nodeCount);
+		shorted.reserve(nodeCount);
+		for (uint32_t i = 0; i < nodeCount; i++) {
+			conducting.add();
+			shorted.add();
+		}
+		// The sources go in first, so an inductor across one is left open whatever order the elements are in
+		for (const auto &[index, elem]: graph.elements | std::views::enumerate) {
+			if (elem.component.get().id != 2) continue;
+			const auto nodes = graph.nodesOf(static_cast<size_t>(index));
+			shorted.unite(nodes[0], nodes[1]);
+		}
+	}
+
+	branches.reserve(graph.elements.size());
+	for (const auto &[index, elem]: graph.elements | std::views::enumerate) {
+		const auto componentId = elem.component.get().id;
+		const auto nodes = graph.nodesOf(static_cast<size_t>(index));
+		auto type = MnaBranch::Type::admittance;
+		if (componentId == 2) {
+			type = MnaBranch::Type::voltageSource;
+		} else if (componentId == 3) {
+			type = MnaBranch::Type::currentSource;
+		} else if (dc && componentId == 6) {
+			type = MnaBranch::Type::open;
+		} else if (dc && componentId == 7) {
+			// An inductor that closes a loop of voltage sources and inductors has its voltage set by them already,
+			// another 0V source there would make the system singular so it is left open and recorded
+			if (shorted.find(nodes[0]) == shorted.find(nodes[1])) {
+				type = MnaBranch::Type::open;
+				shortedInductors.emplace_back(elem.id);
+			} else {
+				type = MnaBranch::Type::voltageSource;
+			}
+			shorted.unite(nodes[0], nodes[1]);
+		}
+		if (type == MnaBranch::Type::voltageSource) voltageSourceCount++;
+		if (dc && (type == MnaBranch::Type::admittance || type == MnaBranch::Type::voltageSource)) {
+			conducting.unite(nodes[0], nodes[1]);
+		}
+
+		branches.emplace_back(MnaBranch{
+			.type = type,
+			.id = elem.id,
+			.nodeA = nodes[0],
+			.nodeB = nodes[1],
+		});
+	}
+
+	if (!dc || nodeCount == 0) return;
+	// A current source between two parts has nowhere to send its current, those parts can't be tied down
+	std::vector<bool> driven(nodeCount, false);
+	for (const auto &branch: branches) {
+		if (branch.type != MnaBranch::Type::currentSource) continue;
+		const auto rootA = conducting.find(branch.nodeA);
+		const auto rootB = conducting.find(branch.nodeB);
+		if (rootA == rootB) continue;
+		driven.at(rootA) = true;
+		driven.at(rootB) = true;
+	}
+	// Only the first node of every floating part is tied down, the rest follow through the part itself
+	std::vector<bool> visited(nodeCount, false);
+	visited.at(conducting.find(0)) = true;
+	for (uint32_t node = 1; node < nodeCount; node++) {
+		const auto root = conducting.find(node);
+		if (visited.at(root)) continue;
+		visited.at(root) = true;
+		(driven.at(root) ? floatingNodes : referenceNodes).emplace_back(node);
+	}
+}
+
+size_t MnaTopology::hash() const {
+	size_t ret = std::hash<uint32_t>{}(nodeCount);
+	const auto combine = [&](size_t value) {
+		ret ^= value + 0x9e3779b97f4a7c15ull + (ret << 6) + (ret >> 2);
+	};
+	for (const auto &node: referenceNodes) {
+		combine(std::hash<uint32_t>{}(node));
+	}
+	for (const auto &branch: branches) {
+		combine(static_cast<size_t>(branch.type));
+		combine(std::hash<ElementId>{}(branch.id));
+		combine(std::hash<uint32_t>{}(branch.nodeA));
+		combine(std::hash<uint32_t>{}(branch.nodeB));
+	}
+	return ret;
+}
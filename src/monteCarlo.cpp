@@ -0,0 +1,238 @@
+#include "monteCarlo.hpp"
+#include "acSimulation.hpp"
+#include "dcSimulation.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+
+void MonteCarlo::Statistics::add(double value) {
+	if (!std::isfinite(value)) return;
+	count++;
+	const auto delta = value - mean;
+	mean += delta / static_cast<double>(count);
+	m2 += delta * (value - mean);
+	min = std::min(min, value);
+	max = std::max(max, value);
+}
+
+void MonteCarlo::Statistics::merge(const Statistics &other) {
+	if (other.count == 0) return;
+	if (count == 0) {
+		*this = other;
+		return;
+	}
+	const auto total = static_cast<double>(count + other.count);
+	const auto delta = other.mean - mean;
+	mean += delta * static_cast<double>(other.count) / total;
+	m2 += other.m2 + delta * delta * static_cast<double>(count) * static_cast<double>(other.count) / total;
+	count += other.count;
+	min = std::min(min, other.min);
+	max = std::max(max, other.max);
+}
+
+void MonteCarlo::Histogram::add(double value) {
+	// Casting a NaN to an index is undefined
+	if (bins.empty() || !std::isfinite(value)) return;
+	const auto position = (value - low) / (high - low) * static_cast<double>(bins.size());
+	bins.at(static_cast<size_t>(std::clamp(position, 0.0, static_cast<double>(bins.size() - 1))))++;
+}
+
+void MonteCarlo::Histogram::merge(const Histogram &other) {
+	for (size_t i = 0; i < bins.size() && i < other.bins.size(); i++) {
+		bins.at(i) += other.bins.at(i);
+	}
+}
+
+MonteCarlo::MonteCarlo(const GraphDescriptor &graph, const Settings &settings) {
+	std::optional<MnaSystem<double>> dcSystem{};
+	std::optional<MnaSystem<std::complex<float>>> acSystem{};
+	*this = MonteCarlo(graph, settings, dcSystem, acSystem);
+}
+
+MonteCarlo::MonteCarlo(const GraphDescriptor &graph, const Settings &settings, std::optional<MnaSystem<double>> &dcSystem, std::optional<MnaSystem<std::complex<float>>> &acSystem, SimulationProgress *progress)
+	: settings(settings) {
+	if (graph.nodeCount < 2 || settings.trials == 0) return;
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::assembly)) return;
+
+	struct RandomizedProperty {
+		size_t element;
+		size_t propertyIndex;
+		float nominal;
+		// Fraction of the nominal value
+		double tolerance;
+		NumberProperty::Distribution distribution;
+	};
+	std::vector<RandomizedProperty> randomized{};
+	// The graph keeps its elements in a fixed order, so the random draws are made in the same order every time
+	for (size_t element = 0; element < graph.elements.size(); element++) {
+		for (const auto &[index, property]: graph.valuesOf(element) | std::views::enumerate) {
+			if (property.tolerance <= 0.f) continue;
+			randomized.emplace_back(RandomizedProperty{
+				.element = element,
+				.propertyIndex = static_cast<size_t>(index),
+				.nominal = property.value,
+				.tolerance = property.tolerance / 100.0,
+				.distribution = property.distribution,
+			});
+		}
+	}
+	randomizedProperties = randomized.size();
+
+	// Solves one trial into values, node voltages first and then the currents
+	const auto solve = [&](const GraphDescriptor &trialGraph, std::optional<MnaSystem<double>> &dc, std::optional<MnaSystem<std::complex<float>>> &ac, std::vector<double> &values) {
+		values.clear();
+		if (settings.analysis == Analysis::dc) {
+			const DCSimulation simulation{trialGraph, dc, nullptr, MnaRefactor::always};
+			if (!simulation.converged || simulation.voltages.empty()) return false;
+			values.insert(values.end(), simulation.voltages.begin(), simulation.voltages.end());
+			for (const auto &current: simulation.currents) values.emplace_back(current.value);
+		} else {
+			const ACSimulation simulation{trialGraph, ac, settings.frequency, nullptr, MnaRefactor::always};
+			if (simulation.voltages.empty()) return false;
+			for (const auto &voltage: simulation.voltages) values.emplace_back(std::abs(voltage));
+			for (const auto &current: simulation.currents) values.emplace_back(std::abs(current.value));
+		}
+		// A diverged value would poison the statistics, the whole trial counts as failed
+		return std::ranges::all_of(values, [](double value) {
+			return std::isfinite(value);
+		});
+	};
+
+	// The nominal board gives the result layout and leaves the system analyzed for the workers to copy
+	std::vector<double> nominalValues{};
+	if (!solve(graph, dcSystem, acSystem, nominalValues)) {
+		std::println("Monte Carlo: the nominal circuit could not be solved");
+		return;
+	}
+	const auto &topology = settings.analysis == Analysis::dc ? dcSystem->topology() : acSystem->topology();
+	const auto nodeCount = static_cast<size_t>(topology.nodeCount) - 1;
+	const auto quantityCount = nominalValues.size();
+	std::vector<ElementId> currentIds{};
+	for (const auto &branch: topology.branches) {
+		if (branch.type == MnaBranch::Type::voltageSource) currentIds.emplace_back(branch.id);
+	}
+	if (settings.analysis == Analysis::dc) {
+		// Diodes
+		for (const auto &element: graph.elementsOf(8)) currentIds.emplace_back(element.id);
+	}
+
+	// Every trial has its own random stream, so the values it draws don't depend on the thread that runs it
+	const auto randomize = [&](GraphDescriptor &trialGraph, uint64_t trial) {
+		std::seed_seq seed{
+			static_cast<uint32_t>(settings.seed),
+			static_cast<uint32_t>(settings.seed >> 32),
+			static_cast<uint32_t>(trial),
+			static_cast<uint32_t>(trial >> 32),
+		};
+		std::mt19937_64 generator{seed};
+		std::uniform_real_distribution<double> uniform{-1.0, 1.0};
+		std::normal_distribution<double> normal{0.0, 1.0 / 3.0};
+		for (const auto &property: randomized) {
+			const auto deviation = property.distribution == NumberProperty::Distribution::gaussian ? normal(generator) : uniform(generator);
+			trialGraph.valuesOf(property.element)[property.propertyIndex].value = static_cast<float>(property.nominal * (1.0 + property.tolerance * deviation));
+		}
+	};
+
+	// Every worker changes the property values in its own copy of the graph and factorizes its own copy of the system
+	struct Worker {
+		std::optional<GraphDescriptor> graph{};
+		std::optional<MnaSystem<double>> dcSystem{};
+		std::optional<MnaSystem<std::complex<float>>> acSystem{};
+		std::vector<double> values{};
+	};
+	auto &pool = ThreadPool::shared();
+	std::vector<Worker> workers(pool.size());
+	std::atomic<uint32_t> failed = 0;
+	std::atomic<uint32_t> done = 0;
+	const auto runTrial = [&](size_t workerIndex, uint64_t trial) -> const std::vector<double> * {
+		if (!SimulationProgress::advance(progress, static_cast<float>(done++) / static_cast<float>(settings.trials))) return nullptr;
+		auto &worker = workers.at(workerIndex);
+		if (!worker.graph.has_value()) {
+			worker.graph.emplace(graph);
+			if (dcSystem.has_value()) worker.dcSystem.emplace(*dcSystem);
+			if (acSystem.has_value()) worker.acSystem.emplace(*acSystem);
+		}
+		randomize(*worker.graph, trial);
+		if (!solve(*worker.graph, worker.dcSystem, worker.acSystem, worker.values) || worker.values.size() != quantityCount) {
+			failed++;
+			return nullptr;
+		}
+		return &worker.values;
+	};
+
+	// The histogram ranges come from a small pilot run, its values are kept and binned once the ranges are known
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::solve)) return;
+	const auto pilotCount = std::min<uint32_t>(settings.trials, 256);
+	std::vector<double> pilotValues(pilotCount * quantityCount, std::numeric_limits<double>::quiet_NaN());
+	pool.parallelFor(pilotCount, [&](size_t workerIndex, size_t trial) {
+		const auto *values = runTrial(workerIndex, trial);
+		if (values == nullptr) return;
+		std::ranges::copy(*values, pilotValues.begin() + static_cast<int64_t>(trial * quantityCount));
+	});
+	if (SimulationProgress::cancelled(progress)) return;
+
+	std::vector<Summary> summaries(quantityCount);
+	for (const auto &[quantity, summary]: summaries | std::views::enumerate) {
+		auto low = nominalValues.at(quantity);
+		auto high = low;
+		for (uint32_t trial = 0; trial < pilotCount; trial++) {
+			const auto value = pilotValues.at(trial * quantityCount + quantity);
+			if (std::isnan(value)) continue;
+			low = std::min(low, value);
+			high = std::max(high, value);
+		}
+		// Leave room for the trials that land outside of what the pilot run saw
+		const auto margin = high > low ? (high - low) * 0.25 : std::max(std::abs(low) * 1e-3, 1e-9);
+		summary.histogram = Histogram{
+			.low = low - margin,
+			.high = high + margin,
+			.bins = std::vector<uint32_t>(std::max(1u, settings.histogramBins)),
+		};
+	}
+	const auto summarize = [](std::vector<Summary> &into, std::span<const double> values) {
+		for (const auto &[summary, value]: std::views::zip(into, values)) {
+			summary.statistics.add(value);
+			summary.histogram.add(value);
+		}
+	};
+
+	// The remaining trials are reduced in a fixed number of blocks that are merged in order,
+	// so the floating point results don't depend on how the blocks were spread over the threads
+	const auto remaining = settings.trials - pilotCount;
+	const auto blockCount = std::min<uint32_t>(64, remaining);
+	std::vector<std::vector<Summary>> blocks(blockCount, summaries);
+	pool.parallelFor(blockCount, [&](size_t workerIndex, size_t block) {
+		const auto begin = pilotCount + static_cast<uint64_t>(remaining) * block / blockCount;
+		const auto end = pilotCount + static_cast<uint64_t>(remaining) * (block + 1) / blockCount;
+		for (auto trial = begin; trial < end; trial++) {
+			const auto *values = runTrial(workerIndex, trial);
+			if (values != nullptr) summarize(blocks.at(block), *values);
+		}
+	});
+	// The results are only filled in at the end, a cancelled run leaves them empty
+	if (SimulationProgress::cancelled(progress)) return;
+
+	for (uint32_t trial = 0; trial < pilotCount; trial++) {
+		const auto values = std::span(pilotValues).subspan(trial * quantityCount, quantityCount);
+		if (std::isnan(values.front())) continue;
+		summarize(summaries, values);
+	}
+	for (const auto &block: blocks) {
+		for (const auto &[summary, blockSummary]: std::views::zip(summaries, block)) {
+			summary.statistics.merge(blockSummary.statistics);
+			summary.histogram.merge(blockSummary.histogram);
+		}
+	}
+
+	failedTrials = failed;
+	if (failedTrials > 0) {
+		std::println("Monte Carlo: {} of {} trials could not be solved", failedTrials, settings.trials);
+	}
+	voltages.assign(summaries.begin(), summaries.begin() + static_cast<int64_t>(nodeCount));
+	currents.reserve(currentIds.size());
+	for (const auto &[index, id]: currentIds | std::views::enumerate) {
+		currents.emplace_back(CurrentSummary{.id = id, .summary = summaries.at(nodeCount + index)});
+	}
+}
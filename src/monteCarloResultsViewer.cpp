@@ -0,0 +1,130 @@
+#include "monteCarloResultsViewer.hpp"
+#include "card.hpp"
+#include "graphView.hpp"
+#include "resultsCard.hpp"
+#include "resultsItem.hpp"
+#include "scrollableFrame.hpp"
+
+
+using namespace squi;
+
+static inline std::vector<std::string_view> columnNames{
+	"Index",
+	"Mean",
+	"Std. dev.",
+	"Min",
+	"Max",
+};
+
+std::vector<Graph::LineValue> generateHistogramData(const MonteCarlo::Histogram &histogram) {
+	std::vector<Graph::LineValue> data{};
+	data.reserve(histogram.bins.size());
+	for (const auto &[index, count]: histogram.bins | std::views::enumerate) {
+		data.emplace_back(Graph::LineValue{
+			.value = static_cast<float>(count),
+			.x = static_cast<float>(histogram.binCenter(index)),
+		});
+	}
+
+	return data;
+}
+
+MonteCarloResultsViewer::operator squi::Child() const {
+	auto storage = std::make_shared<Storage>();
+	// The lambdas share this single copy of the results
+	auto monteCarlo = std::make_shared<const MonteCarlo>(simulation);
+	const auto suffix = simulation.settings.analysis == MonteCarlo::Analysis::dc ? "" : " RMS";
+
+	return ScrollableFrame{
+		.widget{widget},
+		.scrollableWidget{
+			.padding = 4.f,
+		},
+		.spacing = 4.f,
+		.children = [&]() -> Children {
+			Observable<const std::vector<Graph::LineValue> &> graphDataUpdater{};
+			Children ret{
+				Card{
+					.child = GraphView{
+						.widget{
+							.height = 300.f,
+							.margin = 4.f,
+						},
+						.updateData = graphDataUpdater,
+						.values{},
+					},
+				},
+				ResultsCard{
+					.title = "Trials",
+					.columns{"Trials", "Failed", "Randomized properties"},
+					.children{
+						ResultsItem{
+							.items{
+								std::format("{}", simulation.settings.trials),
+								std::format("{}", simulation.failedTrials),
+								std::format("{}", simulation.randomizedProperties),
+							},
+						},
+					},
+				},
+			};
+
+			const auto statisticsItems = [](std::string name, const MonteCarlo::Statistics &statistics, std::string_view unit) {
+				return std::vector<std::string>{
+					std::move(name),
+					std::format("{:.3f}{}", statistics.mean, unit),
+					std::format("{:.3f}{}", statistics.standardDeviation(), unit),
+					std::format("{:.3f}{}", statistics.min, unit),
+					std::format("{:.3f}{}", statistics.max, unit),
+				};
+			};
+
+			if (!simulation.voltages.empty()) {
+				Children voltRet{};
+				for (const auto &[index, summary]: simulation.voltages | std::views::enumerate) {
+					const auto items = statisticsItems(std::format("Node #{}", index + 1), summary.statistics, std::format("V{}", suffix));
+					const auto nodeLines = graph.linesAt(static_cast<uint32_t>(index + 1));
+					voltRet.emplace_back(ResultsItem{
+						.items{items.begin(), items.end()},
+						.onClick = [elementSelector = elementSelector, lines = std::vector<ElementId>{nodeLines.begin(), nodeLines.end()}, graphDataUpdater, monteCarlo, index]() {
+							elementSelector.notify(lines);
+
+							graphDataUpdater.notify(generateHistogramData(monteCarlo->voltages.at(index).histogram));
+						},
+					});
+				}
+				ret.emplace_back(ResultsCard{
+					.title = "Voltages",
+					.columns = columnNames,
+					.children = voltRet,
+				});
+			}
+
+			if (!simulation.currents.empty()) {
+				Children currRet{};
+				for (const auto &[index, current]: simulation.currents | std::views::enumerate) {
+					const auto items = statisticsItems(
+						std::format("{} #{}", board.getElement(current.id)->get().element.component.get().name, current.id),
+						current.summary.statistics,
+						std::format("A{}", suffix)
+					);
+					currRet.emplace_back(ResultsItem{
+						.items{items.begin(), items.end()},
+						.onClick = [elementSelector = elementSelector, id = current.id, graphDataUpdater, monteCarlo, index]() {
+							elementSelector.notify({id});
+
+							graphDataUpdater.notify(generateHistogramData(monteCarlo->currents.at(index).summary.histogram));
+						},
+					});
+				}
+				ret.emplace_back(ResultsCard{
+					.title = "Currents",
+					.columns = columnNames,
+					.children = currRet,
+				});
+			}
+
+			return ret;
+		}(),
+	};
+}
@@ -0,0 +1,481 @@
+#include "netIndex.hpp"
+#include "boardStorage.hpp"
+#include "disjointSet.hpp"
+#include "property/propertyUtils.hpp"
+#include "threadPool.hpp"
+#include <algorithm>
+#include <format>
+#include <limits>
+#include <ranges>
+#include <tuple>
+#include <unordered_set>
+
+static bool isPoint(const BoardStorage &board, const Coords &point) {
+	const auto it = board.connections.find(point);
+	return it != board.connections.end() && !it->second.connections.empty();
+}
+
+// Connection points on the tiles of the line and at both of its ends
+static void forEachLinePoint(const BoardStorage &board, const PointIndex &gridPoints, const Element &line, auto &&func) {
+	// The index can still hold points that were just left empty, until the net they were in is split
+	gridPoints.forEachOn(line, [&](const Coords &point) {
+		if (isPoint(board, point)) func(point);
+	});
+	// The far end isn't one of the line's tiles
+	for (const auto &node: line.nodes) {
+		func(line.pos + node);
+	}
+}
+
+// Lines that pass over the point or end on it
+static void forEachLineAt(const BoardStorage &board, const Coords &point, auto &&func) {
+	const auto visitLine = [&](ElementId id) {
+		if (auto line = board.getLine(id); line.has_value()) func(line->get().element);
+	};
+	board.lineSegments.forEachAt(point, visitLine);
+	if (auto it = board.connections.find(point); it != board.connections.end()) {
+		for (const auto &connection: it->second.connections) {
+			visitLine(connection.elementId);
+		}
+	}
+}
+
+std::optional<NetId> NetIndex::netOf(const Coords &point) const {
+	const auto it = pointNets.find(point);
+	if (it == pointNets.end()) return std::nullopt;
+	return it->second.net;
+}
+
+std::span<const Coords> NetIndex::pointsOf(NetId net) const {
+	const auto it = netPoints.find(net);
+	if (it == netPoints.end()) return {};
+	return it->second;
+}
+
+std::optional<std::string> NetIndex::labelOf(const Element &elem) {
+	const auto &component = elem.component.get();
+	switch (component.type) {
+		case ElementType::Ground:
+			return "GND";
+		case ElementType::Label:
+			// Net labels are named by their text, power labels by the chosen property set
+			if (!elem.propertiesValues.empty()) {
+				if (const auto *text = std::get_if<TextProperty>(&elem.propertiesValues.front())) return text->value;
+				return std::nullopt;
+			}
+			return component.properties.at(elem.propertySetIndex).name;
+		default:
+			return std::nullopt;
+	}
+}
+
+void NetIndex::elementPlaced(const BoardStorage &board, const Element &elem) {
+	if (suspended) return;
+	const auto label = labelOf(elem);
+	if (label.has_value()) labelNames.emplace(elem.id, *label);
+	for (const auto &node: elem.nodes) {
+		const auto point = elem.pos + node;
+		// Pins placed in the middle of a line join it
+		const auto net = joinLinesAt(board, point, addPoint(point));
+		if (label.has_value()) addLabel(*label, point, net);
+	}
+}
+
+void NetIndex::linePlaced(const BoardStorage &board, const Element &elem) {
+	if (suspended) return;
+	auto net = addPoint(elem.pos + elem.nodes.front());
+	forEachLinePoint(board, gridPoints, elem, [&](const Coords &point) {
+		net = merge(net, addPoint(point));
+	});
+	// The ends can also land in the middle of other lines
+	for (const auto &node: elem.nodes) {
+		net = joinLinesAt(board, elem.pos + node, net);
+	}
+}
+
+void NetIndex::elementRemoved(const BoardStorage &board, const Element &elem) {
+	if (suspended) return;
+	const auto labelIt = labelNames.find(elem.id);
+	std::vector<NetId> affected{};
+	for (const auto &node: elem.nodes) {
+		const auto point = elem.pos + node;
+		if (labelIt != labelNames.end()) {
+			if (const auto net = removeLabel(labelIt->second, point); net.has_value()) {
+				affected.emplace_back(*net);
+				continue;
+			}
+		}
+		// Other elements don't join anything, the point only goes away if nothing else is attached to it
+		if (isPoint(board, point)) continue;
+		// unless it was the junction of lines crossing there
+		if (board.lineSegments.at(point).size() > 1) {
+			affected.emplace_back(pointNets.at(point).net);
+			continue;
+		}
+		removePoint(point);
+	}
+	if (labelIt != labelNames.end()) labelNames.erase(labelIt);
+	if (!affected.empty()) split(board, std::move(affected));
+}
+
+void NetIndex::lineRemoved(const BoardStorage &board, const Element &elem) {
+	if (suspended) return;
+	if (const auto net = netOf(elem.pos + elem.nodes.front()); net.has_value()) split(board, {*net});
+}
+
+void NetIndex::elementChanged(const BoardStorage &board, const Element &elem) {
+	if (suspended) return;
+	const auto labelIt = labelNames.find(elem.id);
+	if (labelIt == labelNames.end()) return;
+	const auto label = labelOf(elem);
+	if (!label.has_value() || *label == labelIt->second) return;
+
+	std::vector<NetId> affected{};
+	for (const auto &node: elem.nodes) {
+		if (const auto net = removeLabel(labelIt->second, elem.pos + node); net.has_value()) affected.emplace_back(*net);
+	}
+	labelIt->second = *label;
+	if (!affected.empty()) split(board, std::move(affected));
+	for (const auto &node: elem.nodes) {
+		const auto point = elem.pos + node;
+		addLabel(*label, point, pointNets.at(point).net);
+	}
+}
+
+void NetIndex::rebuild(const BoardStorage &board, ThreadPool *pool) {
+	suspended = false;
+	pointNets.clear();
+	netPoints.clear();
+	labelPoints.clear();
+	labelNames.clear();
+	gridPoints.clear();
+
+	// Runs func(index) for every index, on the pool if there is one
+	const auto forEach = [&](size_t count, auto &&func) {
+		if (pool != nullptr && count > 1) {
+			pool->parallelFor(count, [&](size_t, size_t index) {
+				func(index);
+			});
+		} else {
+			for (size_t index = 0; index < count; index++) func(index);
+		}
+	};
+
+	// The points are split into square regions that are labelled on their own, on separate threads if there is a pool
+	// A line joins every connection point it passes over or ends on, all of them are reported by forEachLineAt
+	// Every region only unites its own points, so the regions never touch the same sets
+	static constexpr int32_t regionShift = 8;
+	const auto regionOf = [](const Coords &point) {
+		return Coords{point.x >> regionShift, point.y >> regionShift};
+	};
+	const auto less = [](const Coords &a, const Coords &b) {
+		return std::tie(a.y, a.x) < std::tie(b.y, b.x);
+	};
+
+	// Every chunk of buckets of the connections sorts its points by region
+	const auto &connections = board.connections;
+	const auto chunkCount = pool != nullptr ? std::min(pool->size() * 4, connections.bucket_count()) : 1uz;
+	std::vector<std::unordered_map<Coords, std::vector<Coords>>> chunkRegions(chunkCount);
+	forEach(chunkCount, [&](size_t chunk) {
+		const auto first = connections.bucket_count() * chunk / chunkCount;
+		const auto last = connections.bucket_count() * (chunk + 1) / chunkCount;
+		for (auto bucket = first; bucket < last; bucket++) {
+			for (auto it = connections.begin(bucket); it != connections.end(bucket); it++) {
+				if (!it->second.connections.empty()) chunkRegions.at(chunk)[regionOf(it->first)].emplace_back(it->first);
+			}
+		}
+	});
+
+	// Regions and the points in them are sorted, so the nets come out numbered the same whatever the hashing and the thread count
+	std::vector<Coords> regions{};
+	for (const auto &chunk: chunkRegions) {
+		for (const auto &[region, _]: chunk) regions.emplace_back(region);
+	}
+	std::ranges::sort(regions, less);
+	regions.erase(std::ranges::unique(regions).begin(), regions.end());
+	std::unordered_map<Coords, uint32_t> regionIndices{};
+	regionIndices.reserve(regions.size());
+	for (const auto &[index, region]: regions | std::views::enumerate) {
+		regionIndices.emplace(region, static_cast<uint32_t>(index));
+	}
+
+	// Every point has an index in the disjoint set, the points of a region have consecutive indices from its offset
+	struct Region {
+		uint32_t offset = 0;
+		std::vector<Coords> points{};
+		// Point -> index in the points of the region
+		std::unordered_map<Coords, uint32_t> indices{};
+	};
+	std::vector<Region> regionPoints(regions.size());
+	forEach(regions.size(), [&](size_t index) {
+		auto &region = regionPoints.at(index);
+		for (const auto &chunk: chunkRegions) {
+			if (const auto it = chunk.find(regions.at(index)); it != chunk.end()) region.points.insert(region.points.end(), it->second.begin(), it->second.end());
+		}
+		std::ranges::sort(region.points, less);
+		region.indices.reserve(region.points.size());
+		for (const auto &[pointIndex, point]: region.points | std::views::enumerate) {
+			region.indices.emplace(point, static_cast<uint32_t>(pointIndex));
+		}
+	});
+	chunkRegions.clear();
+	uint32_t pointCount = 0;
+	for (auto &region: regionPoints) {
+		region.offset = pointCount;
+		pointCount += static_cast<uint32_t>(region.points.size());
+	}
+	const auto indexOf = [&](const Coords &point) {
+		const auto &region = regionPoints.at(regionIndices.at(regionOf(point)));
+		return region.offset + region.indices.at(point);
+	};
+	DisjointSet sets{};
+	sets.resize(pointCount);
+
+	// Lines that leave their region, with the first point they were seen on in every region they cross
+	std::vector<std::vector<std::pair<ElementId, uint32_t>>> borderLines(regionPoints.size());
+	forEach(regionPoints.size(), [&](size_t regionIndex) {
+		const auto &region = regionPoints.at(regionIndex);
+		std::unordered_map<ElementId, uint32_t> firstPoints{};
+		for (const auto &[pointIndex, point]: region.points | std::views::enumerate) {
+			const auto index = region.offset + static_cast<uint32_t>(pointIndex);
+			forEachLineAt(board, point, [&](const Element &line) {
+				const auto [it, inserted] = firstPoints.emplace(line.id, index);
+				if (!inserted) {
+					sets.unite(it->second, index);
+				} else if (std::ranges::any_of(line.nodes, [&](const Coords &node) { return regionOf(line.pos + node) != regionOf(line.pos); })) {
+					borderLines.at(regionIndex).emplace_back(line.id, index);
+				}
+			});
+		}
+	});
+
+	// Stitches the regions together along the lines that cross their borders
+	std::unordered_map<ElementId, uint32_t> linePoints{};
+	for (const auto &lines: borderLines) {
+		for (const auto &[id, index]: lines) {
+			const auto [it, inserted] = linePoints.emplace(id, index);
+			if (!inserted) sets.unite(it->second, index);
+		}
+	}
+
+	// Labels with the same name are the same net, only finding them goes over the whole board
+	const auto elementChunks = pool != nullptr ? std::min(pool->size() * 4, board.elements.size()) : 1uz;
+	std::vector<std::vector<std::pair<const Element *, std::string>>> chunkLabels(elementChunks);
+	forEach(elementChunks, [&](size_t chunk) {
+		const auto first = board.elements.size() * chunk / elementChunks;
+		const auto last = board.elements.size() * (chunk + 1) / elementChunks;
+		for (auto index = first; index < last; index++) {
+			const auto &elem = board.elements.at(index).element;
+			if (auto label = labelOf(elem); label.has_value()) chunkLabels.at(chunk).emplace_back(&elem, std::move(*label));
+		}
+	});
+	for (auto &labels: chunkLabels) {
+		for (auto &[elem, label]: labels) {
+			auto &points = labelPoints[label];
+			for (const auto &node: elem->nodes) {
+				const auto point = node + elem->pos;
+				if (!points.empty()) sets.unite(indexOf(points.begin()->first), indexOf(point));
+				points[point]++;
+			}
+			labelNames.emplace(elem->id, std::move(label));
+		}
+	}
+
+	// Every region numbers the sets it has points in, in the order it meets them
+	// The sets don't change anymore, so root can be called from every region at once
+	struct RegionNets {
+		std::vector<uint32_t> roots{};
+		// Points of the region in every set, and then the net of every set and where its points go in that net
+		std::vector<uint32_t> counts{};
+		std::vector<NetId> nets{};
+		std::vector<uint32_t> offsets{};
+		// Index in roots of every point
+		std::vector<uint32_t> pointSets{};
+	};
+	std::vector<RegionNets> regionNets(regionPoints.size());
+	forEach(regionPoints.size(), [&](size_t regionIndex) {
+		const auto &region = regionPoints.at(regionIndex);
+		auto &local = regionNets.at(regionIndex);
+		std::unordered_map<uint32_t, uint32_t> rootIndices{};
+		local.pointSets.reserve(region.points.size());
+		for (uint32_t pointIndex = 0; pointIndex < region.points.size(); pointIndex++) {
+			const auto [it, inserted] = rootIndices.emplace(sets.root(region.offset + pointIndex), static_cast<uint32_t>(local.roots.size()));
+			if (inserted) {
+				local.roots.emplace_back(it->first);
+				local.counts.emplace_back(0);
+			}
+			local.pointSets.emplace_back(it->second);
+			local.counts.at(it->second)++;
+		}
+	});
+
+	// Remaps the sets of every region to nets, in region order so a set seen by several regions gets the net it got first
+	static constexpr auto unassigned = std::numeric_limits<NetId>::max();
+	std::vector<NetId> setNets(pointCount, unassigned);
+	std::vector<uint32_t> netSizes{};
+	const auto firstNet = nextNet;
+	for (auto &local: regionNets) {
+		local.nets.reserve(local.roots.size());
+		local.offsets.reserve(local.roots.size());
+		for (const auto &[root, count]: std::views::zip(local.roots, local.counts)) {
+			auto &net = setNets.at(root);
+			if (net == unassigned) {
+				net = nextNet++;
+				netSizes.emplace_back(0);
+			}
+			local.nets.emplace_back(net);
+			local.offsets.emplace_back(netSizes.at(net - firstNet));
+			netSizes.at(net - firstNet) += count;
+		}
+	}
+	std::vector<std::vector<Coords> *> members{};
+	members.reserve(netSizes.size());
+	netPoints.reserve(netSizes.size());
+	for (const auto &[index, size]: netSizes | std::views::enumerate) {
+		auto &netMembers = netPoints[firstNet + static_cast<NetId>(index)];
+		netMembers.resize(size);
+		members.emplace_back(&netMembers);
+	}
+
+	// Every point goes to its own slot of its net, so the regions fill the nets at the same time
+	std::vector<Coords> points(pointCount);
+	std::vector<PointInfo> infos(pointCount);
+	forEach(regionPoints.size(), [&](size_t regionIndex) {
+		const auto &region = regionPoints.at(regionIndex);
+		auto &local = regionNets.at(regionIndex);
+		for (const auto &[pointIndex, point]: region.points | std::views::enumerate) {
+			const auto set = local.pointSets.at(static_cast<size_t>(pointIndex));
+			const auto net = local.nets.at(set);
+			const auto index = local.offsets.at(set)++;
+			members.at(net - firstNet)->at(index) = point;
+			points.at(region.offset + static_cast<size_t>(pointIndex)) = point;
+			infos.at(region.offset + static_cast<size_t>(pointIndex)) = PointInfo{net, index};
+		}
+	});
+	// A single map can't take inserts from several threads, everything it gets was worked out above
+	pointNets.reserve(pointCount);
+	for (const auto &[point, info]: std::views::zip(points, infos)) {
+		pointNets.emplace(point, info);
+	}
+	gridPoints.build(points, pool);
+}
+
+NetId NetIndex::joinLinesAt(const BoardStorage &board, const Coords &point, NetId net) {
+	forEachLineAt(board, point, [&](const Element &line) {
+		net = merge(net, pointNets.at(line.pos + line.nodes.front()).net);
+	});
+	return net;
+}
+
+NetId NetIndex::addPoint(const Coords &point) {
+	if (auto it = pointNets.find(point); it != pointNets.end()) return it->second.net;
+	const auto net = nextNet++;
+	pointNets.emplace(point, PointInfo{net, 0});
+	netPoints[net].emplace_back(point);
+	gridPoints.add(point);
+	return net;
+}
+
+void NetIndex::removePoint(const Coords &point) {
+	const auto it = pointNets.find(point);
+	if (it == pointNets.end()) return;
+	const auto [net, index] = it->second;
+	pointNets.erase(it);
+	gridPoints.remove(point);
+
+	auto &points = netPoints.at(net);
+	const auto last = points.back();
+	points.pop_back();
+	if (index < points.size()) {
+		points.at(index) = last;
+		pointNets.at(last).index = index;
+	}
+	if (points.empty()) netPoints.erase(net);
+}
+
+NetId NetIndex::addLabel(const std::string &name, const Coords &point, NetId net) {
+	auto &points = labelPoints[name];
+	if (!points.empty()) net = merge(net, pointNets.at(points.begin()->first).net);
+	points[point]++;
+	return net;
+}
+
+std::optional<NetId> NetIndex::removeLabel(const std::string &name, const Coords &point) {
+	const auto labelIt = labelPoints.find(name);
+	if (labelIt == labelPoints.end()) return std::nullopt;
+	auto &points = labelIt->second;
+	const auto it = points.find(point);
+	if (it == points.end() || --it->second > 0) return std::nullopt;
+	points.erase(it);
+	if (points.empty()) labelPoints.erase(labelIt);
+	// The label might have been the only thing joining this point to the others with the same name
+	return netOf(point);
+}
+
+NetId NetIndex::merge(NetId a, NetId b) {
+	if (a == b) return a;
+	if (netPoints.at(a).size() < netPoints.at(b).size()) std::swap(a, b);
+	auto &points = netPoints.at(a);
+	for (const auto &point: netPoints.at(b)) {
+		pointNets.at(point) = PointInfo{a, static_cast<uint32_t>(points.size())};
+		points.emplace_back(point);
+	}
+	netPoints.erase(b);
+	return a;
+}
+
+void NetIndex::split(const BoardStorage &board, std::vector<NetId> nets) {
+	std::ranges::sort(nets);
+	const auto [first, last] = std::ranges::unique(nets);
+	nets.erase(first, last);
+
+	std::vector<Coords> points{};
+	for (const auto &net: nets) {
+		const auto it = netPoints.find(net);
+		if (it == netPoints.end()) continue;
+		points.insert(points.end(), it->second.begin(), it->second.end());
+		netPoints.erase(it);
+	}
+	for (const auto &point: points) {
+		pointNets.erase(point);
+	}
+
+	// Everything that was connected before is in these nets, so the exploration never leaves them
+	std::unordered_set<ElementId> exploredLines{};
+	std::unordered_set<std::string> exploredLabels{};
+	std::vector<Coords> stack{};
+	for (const auto &start: points) {
+		if (pointNets.contains(start) || !isPoint(board, start)) continue;
+		const auto net = nextNet++;
+		auto &members = netPoints[net];
+		const auto visit = [&](const Coords &point) {
+			if (!pointNets.emplace(point, PointInfo{net, static_cast<uint32_t>(members.size())}).second) return;
+			members.emplace_back(point);
+			stack.emplace_back(point);
+		};
+
+		visit(start);
+		while (!stack.empty()) {
+			const auto point = stack.back();
+			stack.pop_back();
+			forEachLineAt(board, point, [&](const Element &line) {
+				if (exploredLines.emplace(line.id).second) forEachLinePoint(board, gridPoints, line, visit);
+			});
+			for (const auto &connection: board.connections.at(point).connections) {
+				const auto labelIt = labelNames.find(connection.elementId);
+				if (labelIt == labelNames.end() || !exploredLabels.emplace(labelIt->second).second) continue;
+				// A renamed label isn't listed under its new name yet
+				const auto pointsIt = labelPoints.find(labelIt->second);
+				if (pointsIt == labelPoints.end()) continue;
+				for (const auto &[other, _]: pointsIt->second) {
+					visit(other);
+				}
+			}
+		}
+	}
+
+	// Points that nothing is attached to anymore weren't visited
+	for (const auto &point: points) {
+		if (!pointNets.contains(point)) gridPoints.remove(point);
+	}
+}
@@ -0,0 +1,129 @@
+#include "netlistBuilder.hpp"
+#include "components/componentStore.hpp"
+#include <algorithm>
+#include <limits>
+#include <print>
+#include <ranges>
+
+static constexpr auto unused = std::numeric_limits<uint32_t>::max();
+
+uint32_t NetlistBuilder::addNode() {
+	return nodes++;
+}
+
+std::optional<uint32_t> NetlistBuilder::nodeIndex(uint32_t node) const {
+	if (node >= builtNodeIds.size() || builtNodeIds.at(node) == unused) return std::nullopt;
+	return builtNodeIds.at(node);
+}
+
+std::optional<ElementId> NetlistBuilder::addElement(Type type, std::span<const uint32_t> pins, std::span<const float> newValues, uint32_t propertySetIndex) {
+	const auto componentId = static_cast<uint32_t>(type);
+	const auto &component = ComponentStore::components.at(componentId).get();
+	if (pins.size() != component.nodes.size()) {
+		std::println(stderr, "Netlist builder: {} needs {} pins, got {}", component.name, component.nodes.size(), pins.size());
+		return std::nullopt;
+	}
+	if (propertySetIndex >= std::max<size_t>(1, component.properties.size())) {
+		std::println(stderr, "Netlist builder: {} has no property set {}", component.name, propertySetIndex);
+		return std::nullopt;
+	}
+	if (const auto node = std::ranges::find_if(pins, [&](uint32_t node) { return node >= nodes; }); node != pins.end()) {
+		std::println(stderr, "Netlist builder: node {} of a {} was never added", *node, component.name);
+		return std::nullopt;
+	}
+	const auto valueCount = component.properties.empty() ? 0uz : component.properties.at(propertySetIndex).properties.size();
+	if (newValues.size() > valueCount) {
+		std::println(stderr, "Netlist builder: {} takes at most {} values, got {}", component.name, valueCount, newValues.size());
+		return std::nullopt;
+	}
+
+	entries.emplace_back(Entry{
+		.componentId = componentId,
+		.propertySetIndex = propertySetIndex,
+	});
+	pinNodes.insert(pinNodes.end(), pins.begin(), pins.end());
+	pinOffsets.emplace_back(static_cast<uint32_t>(pinNodes.size()));
+	values.insert(values.end(), newValues.begin(), newValues.end());
+	valueOffsets.emplace_back(static_cast<uint32_t>(values.size()));
+	return static_cast<ElementId>(entries.size());
+}
+
+GraphDescriptor NetlistBuilder::build() {
+	GraphDescriptor ret{};
+
+	// Counting sort by component, the elements of a component stay in the order they were added so they are sorted by id
+	uint32_t maxComponentId = 0;
+	for (const auto &entry: entries) maxComponentId = std::max(maxComponentId, entry.componentId);
+	ret.componentOffsets.assign(maxComponentId + 2, 0);
+	std::vector<uint32_t> order{};
+	order.reserve(entries.size());
+	for (const auto &[index, entry]: entries | std::views::enumerate) {
+		const auto pins = std::span(pinNodes).subspan(pinOffsets.at(index), pinOffsets.at(index + 1) - pinOffsets.at(index));
+		if (std::ranges::adjacent_find(pins, std::ranges::not_equal_to()) == pins.end()) {
+			if (GraphDescriptor::verbose) std::println("Note: {}{} ignored due to having all connections on the same node", ComponentStore::components.at(entry.componentId).get().prefix, index + 1);
+			continue;
+		}
+		ret.componentOffsets.at(entry.componentId + 1)++;
+		order.emplace_back(static_cast<uint32_t>(index));
+	}
+	for (size_t i = 1; i < ret.componentOffsets.size(); i++) {
+		ret.componentOffsets.at(i) += ret.componentOffsets.at(i - 1);
+	}
+
+	// A node without elements would be a row of zeros in the system, the ground keeps index 0 either way
+	std::vector<uint32_t> nodeIds(nodes, unused);
+	nodeIds.at(ground) = 0;
+	for (const auto &index: order) {
+		for (auto pin = pinOffsets.at(index); pin < pinOffsets.at(index + 1); pin++) {
+			nodeIds.at(pinNodes.at(pin)) = 0;
+		}
+	}
+	ret.nodeCount = 0;
+	for (auto &id: nodeIds) {
+		if (id != unused) id = ret.nodeCount++;
+	}
+
+	std::ranges::stable_sort(order, {}, [&](uint32_t index) {
+		return entries.at(index).componentId;
+	});
+
+	ret.elements.reserve(order.size());
+	ret.pinOffsets.reserve(order.size() + 1);
+	ret.pinNodes.reserve(pinNodes.size());
+	ret.valueOffsets.reserve(order.size() + 1);
+	ret.values.reserve(values.size());
+	for (const auto &index: order) {
+		const auto &entry = entries.at(index);
+		const auto &component = ComponentStore::components.at(entry.componentId).get();
+		ret.elements.emplace_back(GraphDescriptor::GraphElement{
+			.component = component,
+			.id = index + 1,
+			.propertySetIndex = entry.propertySetIndex,
+		});
+		ret.pinOffsets.emplace_back(static_cast<uint32_t>(ret.pinNodes.size()));
+		for (auto pin = pinOffsets.at(index); pin < pinOffsets.at(index + 1); pin++) {
+			ret.pinNodes.emplace_back(nodeIds.at(pinNodes.at(pin)));
+		}
+
+		ret.valueOffsets.emplace_back(static_cast<uint32_t>(ret.values.size()));
+		if (component.properties.empty()) continue;
+		const auto given = std::span(values).subspan(valueOffsets.at(index), valueOffsets.at(index + 1) - valueOffsets.at(index));
+		for (const auto &[propertyIndex, property]: component.properties.at(entry.propertySetIndex).properties | std::views::enumerate) {
+			ret.values.emplace_back(GraphDescriptor::Value{
+				.value = static_cast<size_t>(propertyIndex) < given.size() ? given[static_cast<size_t>(propertyIndex)] : property.defaultValue,
+				.tolerance = 0.f,
+				.distribution = NumberProperty::Distribution::uniform,
+			});
+		}
+	}
+	ret.pinOffsets.emplace_back(static_cast<uint32_t>(ret.pinNodes.size()));
+	ret.valueOffsets.emplace_back(static_cast<uint32_t>(ret.values.size()));
+
+	ret.indexNodes();
+	// There are no lines to show for any node
+	ret.nodeLineOffsets.assign(ret.nodeCount + 1, 0);
+
+	*this = NetlistBuilder{};
+	builtNodeIds = std::move(nodeIds);
+	return ret;
+}
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "box.hpp"
 #include "config.hpp"
 #include "text.hpp"
+#include "viewUtils.hpp"
 
 using namespace squi;
 
@@ -18,7 +19,7 @@ NodeIndexDisplay::operator squi::Child() const {
             },
             .padding = Padding{4.f, 0.f},
             .onArrange = [coords = pos](Widget &w, vec2& pos){
-                pos += coords.toVec() * gridSize - w.getSize() / 2.f;
+                pos += Utils::toVec(coords) * gridSize - w.getSize() / 2.f;
             },
 		},
 		.color{0x000000FF},
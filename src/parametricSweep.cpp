@@ -0,0 +1,98 @@
+#include "parametricSweep.hpp"
+#include "threadPool.hpp"
+
+
+ParametricSweep::ParametricSweep(const GraphDescriptor &graph, std::vector<Parameter> parameters) {
+	std::optional<MnaSystem<double>> system{};
+	*this = ParametricSweep(graph, std::move(parameters), system);
+}
+
+ParametricSweep::ParametricSweep(const GraphDescriptor &graph, std::vector<Parameter> newParameters, std::optional<MnaSystem<double>> &system, SimulationProgress *progress)
+	: parameters(std::move(newParameters)) {
+	if (graph.nodeCount < 2) return;
+	std::vector<size_t> parameterElements{};
+	parameterElements.reserve(parameters.size());
+	for (const auto &parameter: parameters) {
+		const auto index = graph.indexOf(parameter.id);
+		if (!index.has_value() || parameter.propertyIndex >= graph.valuesOf(*index).size()) {
+			std::println("Parametric sweep: element #{} has no property {}", parameter.id, parameter.propertyIndex);
+			return;
+		}
+		parameterElements.emplace_back(*index);
+	}
+	pointCount = parameters.empty() ? 0 : 1;
+	for (const auto &parameter: parameters) {
+		pointCount *= parameter.values.size();
+	}
+	if (pointCount == 0) return;
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::assembly)) return;
+
+	// Solving the unchanged board leaves system analyzed for this topology, the workers copy it from there
+	DCSimulation{graph, system, nullptr, MnaRefactor::always};
+	// No point in the sweep can be solved, the nominal run already said why
+	if (!system->topology().floatingNodes.empty() || !system->topology().shortedInductors.empty()) return;
+	nodeCount = system->topology().nodeCount - 1;
+	currentIds.reserve(system->topology().voltageSourceCount);
+	for (const auto &branch: system->topology().branches) {
+		if (branch.type == MnaBranch::Type::voltageSource) currentIds.emplace_back(branch.id);
+	}
+	// Diodes
+	for (const auto &element: graph.elementsOf(8)) {
+		currentIds.emplace_back(element.id);
+	}
+	voltages.resize(pointCount * nodeCount);
+	currents.resize(pointCount * currentIds.size());
+
+	// Every worker gets its own copy of the graph to change the property values in
+	// and its own copy of the system, which shares the ordering and pattern of the original
+	auto &pool = ThreadPool::shared();
+	std::vector<std::optional<GraphDescriptor>> workerGraphs(pool.size());
+	std::vector<std::optional<MnaSystem<double>>> workerSystems(pool.size());
+	std::atomic<size_t> failed = 0;
+	std::atomic<size_t> done = 0;
+
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::solve)) return;
+	pool.parallelFor(pointCount, [&](size_t workerIndex, size_t pointIndex) {
+		if (!SimulationProgress::advance(progress, static_cast<float>(done++) / static_cast<float>(pointCount))) return;
+		auto &workerGraph = workerGraphs.at(workerIndex);
+		auto &workerSystem = workerSystems.at(workerIndex);
+		if (!workerGraph.has_value()) workerGraph.emplace(graph);
+		if (!workerSystem.has_value()) workerSystem.emplace(*system);
+
+		for (const auto &[parameterIndex, parameter]: parameters | std::views::enumerate) {
+			workerGraph->valuesOf(parameterElements.at(parameterIndex))[parameter.propertyIndex].value = parameterValue(pointIndex, parameterIndex);
+		}
+
+		const DCSimulation simulation{*workerGraph, workerSystem, nullptr, MnaRefactor::always};
+		auto pointVoltages = std::span(voltages).subspan(pointIndex * nodeCount, nodeCount);
+		auto pointCurrents = std::span(currents).subspan(pointIndex * currentIds.size(), currentIds.size());
+		if (!simulation.converged || simulation.voltages.size() != nodeCount || simulation.currents.size() != currentIds.size()) {
+			failed++;
+			std::ranges::fill(pointVoltages, std::numeric_limits<float>::quiet_NaN());
+			std::ranges::fill(pointCurrents, std::numeric_limits<float>::quiet_NaN());
+			return;
+		}
+		std::ranges::copy(simulation.voltages, pointVoltages.begin());
+		for (size_t i = 0; i < pointCurrents.size(); i++) {
+			pointCurrents[i] = simulation.currents[i].value;
+		}
+	});
+	if (SimulationProgress::cancelled(progress)) {
+		voltages.clear();
+		currents.clear();
+		return;
+	}
+
+	failedPoints = failed;
+	if (failedPoints > 0) {
+		std::println("Parametric sweep: {} of {} points could not be solved", failedPoints, pointCount);
+	}
+}
+
+float ParametricSweep::parameterValue(size_t point, size_t parameter) const {
+	for (size_t i = 0; i < parameter; i++) {
+		point /= parameters.at(i).values.size();
+	}
+	const auto &values = parameters.at(parameter).values;
+	return values.at(point % values.size());
+}
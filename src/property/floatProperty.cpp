@@ -1,81 +1,28 @@
 #include "property/floatProperty.hpp"
-#include "container.hpp"
-#include "numberBox.hpp"
 #include "property/propertyUtils.hpp"
-#include "row.hpp"
-#include "text.hpp"
-
-using namespace squi;
-
-NumberProperty::Input::operator squi::Child() const {
-	VoidObservable selectAllObs{};
-	auto storage = std::make_shared<Storage>(value, value);
-
-	return Row{
-		.widget{
-			.height = Size::Shrink,
-			.onInit = [submitObs = closeObs, storage](Widget &w) {
-				w.customState.add(submitObs.observe([storage]() {
-					storage->value = storage->newValue;
-				}));
-			},
-		},
-		.alignment = Row::Alignment::center,
-		.children{
-			Text{
-				.text{name},
-			},
-			Container{},
-			NumberBox{
-				.widget{
-					.afterInit = [focusObs = focusObs, selectAllObs](Widget &w) {
-						w.customState.add(
-							focusObs.observe([selectAllObs](bool focus) {
-								if (focus) {
-									selectAllObs.notify();
-								}
-							})
-						);
-					},
-				},
-				.value = value,
-				.onChange = [storage](float newVal) {
-					storage->newValue = newVal;
-				},
-				.controller{
-					.focus = focusObs,
-					.selectAll = selectAllObs,
-				},
-			},
-		},
-	};
-}
+#include <format>
+#include <stdexcept>
 
 NumberProperty NumberProperty::fromData(const PropertyData &data) {
 	return {
 		.name = data.name,
 		.suffix = data.suffix,
-		.value = 0.f,
-	};
-}
-
-squi::Child NumberProperty::createInput(const squi::VoidObservable &closeObs, const squi::Observable<bool> &focusObs) const {
-	return Input{
-		.closeObs = closeObs,
-		.focusObs = focusObs,
-		.name = name,
-		.value = value,
+		.value = data.defaultValue,
 	};
 }
 
 constexpr auto ind = Utils::getIndexFromTuple<NumberProperty, PropertiesTypes>();
-const uint64_t size = sizeof(uint64_t) + sizeof(ind) + sizeof(NumberProperty::value);
+// Saves made before the tolerance was added only have the value
+const uint64_t valueOnlySize = sizeof(uint64_t) + sizeof(ind) + sizeof(NumberProperty::value);
+const uint64_t size = valueOnlySize + sizeof(NumberProperty::tolerance) + sizeof(NumberProperty::distribution);
 std::vector<std::byte> NumberProperty::serialize() const {
 	std::vector<std::byte> ret{};
 	ret.reserve(size);
 	Utils::addBytes(ret, size);
 	Utils::addBytes(ret, ind);
 	Utils::addBytes(ret, value);
+	Utils::addBytes(ret, tolerance);
+	Utils::addBytes(ret, distribution);
 
 	return ret;
 }
@@ -93,16 +40,21 @@ NumberProperty NumberProperty::deserialize(const std::span<const std::byte> &byt
 	if (dataIndex != ind) {
 		throw std::runtime_error("Deserialize called on the wrong property");
 	}
-	if (dataSize != size) {
+	if (dataSize != size && dataSize != valueOnlySize) {
 		throw std::runtime_error("Data size does not match the size of the property");
 	}
 	ret.name = data.name;
 	ret.suffix = data.suffix;
 	ret.value = Utils::bytesTo<decltype(ret.value)>(it);
+	if (dataSize == size) {
+		ret.tolerance = Utils::bytesTo<decltype(ret.tolerance)>(it);
+		ret.distribution = Utils::bytesTo<decltype(ret.distribution)>(it);
+	}
 
 	return ret;
 }
 
 std::string NumberProperty::display() const {
+	if (tolerance > 0.f) return std::format("{}{} ±{}%", value, suffix, tolerance);
 	return std::format("{}{}", value, suffix);
 }
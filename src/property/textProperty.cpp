@@ -0,0 +1,57 @@
+#include "property/textProperty.hpp"
+#include "property/propertyUtils.hpp"
+#include <stdexcept>
+
+TextProperty TextProperty::fromData(const PropertyData &data) {
+	return {
+		.name = data.name,
+		.value = data.defaultText,
+	};
+}
+
+constexpr auto ind = Utils::getIndexFromTuple<TextProperty, PropertiesTypes>();
+// Size and type index, followed by the length of the text and the text itself
+const uint64_t headerSize = sizeof(uint64_t) + sizeof(ind) + sizeof(uint64_t);
+std::vector<std::byte> TextProperty::serialize() const {
+	std::vector<std::byte> ret{};
+	const uint64_t size = headerSize + value.size();
+	ret.reserve(size);
+	Utils::addBytes(ret, size);
+	Utils::addBytes(ret, ind);
+	Utils::addBytes(ret, static_cast<uint64_t>(value.size()));
+	for (const auto &c: value) {
+		ret.emplace_back(static_cast<std::byte>(c));
+	}
+
+	return ret;
+}
+
+TextProperty TextProperty::deserialize(const std::span<const std::byte> &bytes, const PropertyData &data) {
+	TextProperty ret{};
+
+	auto it = bytes.begin();
+
+	auto dataSize = Utils::bytesTo<uint64_t>(it);
+	auto dataIndex = Utils::bytesTo<decltype(ind)>(it);
+	if (dataIndex != data.type) {
+		throw std::runtime_error("Data type and property type don't match");
+	}
+	if (dataIndex != ind) {
+		throw std::runtime_error("Deserialize called on the wrong property");
+	}
+	const auto length = Utils::bytesTo<uint64_t>(it);
+	if (dataSize != headerSize + length || dataSize > bytes.size()) {
+		throw std::runtime_error("Data size does not match the size of the property");
+	}
+	ret.name = data.name;
+	ret.value.reserve(length);
+	for (uint64_t i = 0; i < length; i++) {
+		ret.value.push_back(static_cast<char>(*it++));
+	}
+
+	return ret;
+}
+
+std::string TextProperty::display() const {
+	return value;
+}
\ No newline at end of file
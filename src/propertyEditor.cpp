@@ -9,6 +9,7 @@
 #include "fontIcon.hpp"
 #include "gestureDetector.hpp"
 #include "observer.hpp"
+#include "propertyInput.hpp"
 #include "row.hpp"
 #include "scrollableFrame.hpp"
 #include "stack.hpp"
@@ -91,8 +92,8 @@ struct Content {
 
 		for (const auto &[prop, focusObservable]: std::views::zip(storage->props, storage->focusObservables)) {
 			std::visit(
-				[&](PropertyLike auto &&item) {
-					ret.emplace_back(item.createInput(saveObs, focusObservable));
+				[&](EditableProperty auto &&item) {
+					ret.emplace_back(createPropertyInput(item, saveObs, focusObservable));
 				},
 				prop
 			);
@@ -190,6 +191,7 @@ PropertyEditor::operator squi::Child() const {
 		.props = element.propertiesValues,
 		.focusObservables = std::vector<Observable<bool>>(element.propertiesValues.size()),
 		.element = element,
+		.onSave = onSave,
 	});
 
 	return Stack{
@@ -200,6 +202,7 @@ PropertyEditor::operator squi::Child() const {
 						storage->element.propertySetIndex = storage->propIndex;
 						storage->saveObs.notify();
 						storage->element.propertiesValues = storage->props;
+						if (storage->onSave) storage->onSave();
 					}
 					w.deleteLater();
 				}));
@@ -0,0 +1,191 @@
+#include "propertyInput.hpp"
+#include "button.hpp"
+#include "column.hpp"
+#include "container.hpp"
+#include "contextMenu.hpp"
+#include "numberBox.hpp"
+#include "row.hpp"
+#include "text.hpp"
+#include "textBox.hpp"
+#include "window.hpp"
+
+using namespace squi;
+
+static std::string_view distributionName(NumberProperty::Distribution distribution) {
+	switch (distribution) {
+		case NumberProperty::Distribution::uniform:
+			return "Uniform";
+		case NumberProperty::Distribution::gaussian:
+			return "Gaussian";
+	}
+	return "";
+}
+
+NumberPropertyInput::operator squi::Child() const {
+	VoidObservable selectAllObs{};
+	auto storage = std::make_shared<Storage>(value, value, tolerance, tolerance, distribution, distribution);
+
+	return Column{
+		.widget{
+			.height = Size::Shrink,
+			.onInit = [submitObs = closeObs, storage](Widget &w) {
+				w.customState.add(submitObs.observe([storage]() {
+					storage->value = storage->newValue;
+					storage->tolerance = storage->newTolerance;
+					storage->distribution = storage->newDistribution;
+				}));
+			},
+		},
+		.children{
+			Row{
+				.widget{
+					.height = Size::Shrink,
+				},
+				.alignment = Row::Alignment::center,
+				.children{
+					Text{
+						.text{name},
+					},
+					Container{},
+					NumberBox{
+						.widget{
+							.afterInit = [focusObs = focusObs, selectAllObs](Widget &w) {
+								w.customState.add(
+									focusObs.observe([selectAllObs](bool focus) {
+										if (focus) {
+											selectAllObs.notify();
+										}
+									})
+								);
+							},
+						},
+						.value = value,
+						.onChange = [storage](float newVal) {
+							storage->newValue = newVal;
+						},
+						.controller{
+							.focus = focusObs,
+							.selectAll = selectAllObs,
+						},
+					},
+				},
+			},
+			Row{
+				.widget{
+					.height = Size::Shrink,
+					.margin = Margin{4.f, 0.f, 0.f, 0.f},
+				},
+				.alignment = Row::Alignment::center,
+				.spacing = 4.f,
+				.children{
+					Text{
+						.text{"Tolerance (%)"},
+						.fontSize = 12.f,
+					},
+					Container{},
+					Button{
+						.style = ButtonStyle::Standard(),
+						.onClick = [storage](GestureDetector::Event event) {
+							Window::of(&event.widget).addOverlay(ContextMenu{
+								.position = event.widget.getPos().withYOffset(event.widget.getLayoutSize().y),
+								.items{
+									ContextMenu::Item{
+										.text = "Uniform",
+										.content = [storage]() {
+											storage->newDistribution = NumberProperty::Distribution::uniform;
+										},
+									},
+									ContextMenu::Item{
+										.text = "Gaussian",
+										.content = [storage]() {
+											storage->newDistribution = NumberProperty::Distribution::gaussian;
+										},
+									},
+								},
+							});
+						},
+						.child = Text{
+							.widget{
+								.onUpdate = [storage](Widget &w) {
+									w.as<Text::Impl>().setText(distributionName(storage->newDistribution));
+								},
+							},
+							.text = distributionName(distribution),
+						},
+					},
+					NumberBox{
+						.value = tolerance,
+						.onChange = [storage](float newVal) {
+							storage->newTolerance = std::max(newVal, 0.f);
+						},
+					},
+				},
+			},
+		},
+	};
+}
+
+squi::Child createPropertyInput(const NumberProperty &property, const squi::VoidObservable &closeObs, const squi::Observable<bool> &focusObs) {
+	return NumberPropertyInput{
+		.closeObs = closeObs,
+		.focusObs = focusObs,
+		.name = property.name,
+		.value = property.value,
+		.tolerance = property.tolerance,
+		.distribution = property.distribution,
+	};
+}
+
+
+TextPropertyInput::operator squi::Child() const {
+	VoidObservable selectAllObs{};
+	auto storage = std::make_shared<Storage>(value, value);
+
+	return Row{
+		.widget{
+			.height = Size::Shrink,
+			.onInit = [submitObs = closeObs, storage](Widget &w) {
+				w.customState.add(submitObs.observe([storage]() {
+					storage->value = storage->newValue;
+				}));
+			},
+		},
+		.alignment = Row::Alignment::center,
+		.children{
+			Text{
+				.text{name},
+			},
+			Container{},
+			TextBox{
+				.widget{
+					.afterInit = [focusObs = focusObs, selectAllObs](Widget &w) {
+						w.customState.add(
+							focusObs.observe([selectAllObs](bool focus) {
+								if (focus) {
+									selectAllObs.notify();
+								}
+							})
+						);
+					},
+				},
+				.text = value,
+				.onChange = [storage](std::string_view newVal) {
+					storage->newValue = newVal;
+				},
+				.controller{
+					.focus = focusObs,
+					.selectAll = selectAllObs,
+				},
+			},
+		},
+	};
+}
+
+squi::Child createPropertyInput(const TextProperty &property, const squi::VoidObservable &closeObs, const squi::Observable<bool> &focusObs) {
+	return TextPropertyInput{
+		.closeObs = closeObs,
+		.focusObs = focusObs,
+		.name = property.name,
+		.value = property.value,
+	};
+}
\ No newline at end of file
@@ -0,0 +1,160 @@
+#include "resultCache.hpp"
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+
+static void combine(size_t &seed, size_t value) {
+	seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+}
+
+CanonicalNetlist::CanonicalNetlist(const GraphDescriptor &graph) : nodeCount(graph.nodeCount) {
+	struct Item {
+		ElementId id;
+		Record record;
+		// Colour of the element itself, without its neighbourhood
+		size_t base = 0;
+		size_t colour = 0;
+	};
+	std::vector<Item> items{};
+	items.reserve(graph.elements.size());
+	uint32_t maxNode = 0;
+	for (const auto &[index, elem]: graph.elements | std::views::enumerate) {
+		const auto nodes = graph.nodesOf(static_cast<size_t>(index));
+		const auto values = graph.valuesOf(static_cast<size_t>(index));
+		auto &item = items.emplace_back(Item{
+			.id = elem.id,
+			.record{
+				.componentId = elem.component.get().id,
+				.propertySetIndex = elem.propertySetIndex,
+				.properties{values.begin(), values.end()},
+				.nodes{nodes.begin(), nodes.end()},
+			},
+		});
+		item.base = std::hash<uint32_t>{}(item.record.componentId);
+		combine(item.base, item.record.propertySetIndex);
+		for (const auto &property: item.record.properties) {
+			combine(item.base, std::bit_cast<uint32_t>(property.value));
+			combine(item.base, std::bit_cast<uint32_t>(property.tolerance));
+			combine(item.base, static_cast<size_t>(property.distribution));
+		}
+		for (const auto &node: nodes) maxNode = std::max(maxNode, node);
+	}
+
+	// Node 0 is the reference node, it keeps its own colour so the voltages stay relative to it
+	std::vector<size_t> nodeColours(items.empty() ? 0 : maxNode + 1);
+	if (!nodeColours.empty()) nodeColours.front() = 1;
+	std::vector<std::vector<size_t>> neighbourhoods(nodeColours.size());
+	size_t colourCount = std::min<size_t>(nodeColours.size(), 2);
+	// Every round either splits a colour class or changes nothing, but on long chains like ladders it only settles after
+	// one round per node, so the rounds are capped and the element ids break the ties that are left
+	static constexpr size_t maxRounds = 4;
+	for (size_t round = 0; round < maxRounds; round++) {
+		for (auto &item: items) {
+			item.colour = item.base;
+			for (const auto &node: item.record.nodes) combine(item.colour, nodeColours.at(node));
+		}
+		for (auto &neighbourhood: neighbourhoods) neighbourhood.clear();
+		for (const auto &item: items) {
+			for (const auto &[pin, node]: item.record.nodes | std::views::enumerate) {
+				auto colour = item.colour;
+				combine(colour, static_cast<size_t>(pin));
+				neighbourhoods.at(node).emplace_back(colour);
+			}
+		}
+		for (auto &&[colour, neighbourhood]: std::views::zip(nodeColours, neighbourhoods)) {
+			std::ranges::sort(neighbourhood);
+			for (const auto &value: neighbourhood) combine(colour, value);
+		}
+
+		auto distinct = nodeColours;
+		std::ranges::sort(distinct);
+		const auto newCount = static_cast<size_t>(std::distance(distinct.begin(), std::ranges::unique(distinct).begin()));
+		if (newCount == colourCount && round > 0) break;
+		colourCount = newCount;
+	}
+
+	// Elements with the same colour are ordered by their id, equivalent netlists that differ there only miss the cache
+	std::ranges::sort(items, [](const Item &a, const Item &b) {
+		return std::tie(a.colour, a.id) < std::tie(b.colour, b.id);
+	});
+
+	hash = std::hash<uint32_t>{}(nodeCount);
+	std::vector<uint32_t> canonicalNodes(nodeColours.size(), std::numeric_limits<uint32_t>::max());
+	if (!canonicalNodes.empty()) {
+		canonicalNodes.front() = 0;
+		nodeIndices.emplace_back(0);
+	}
+	records.reserve(items.size());
+	elementIds.reserve(items.size());
+	for (auto &item: items) {
+		combine(hash, item.colour);
+		for (auto &node: item.record.nodes) {
+			if (canonicalNodes.at(node) == std::numeric_limits<uint32_t>::max()) {
+				canonicalNodes.at(node) = static_cast<uint32_t>(nodeIndices.size());
+				nodeIndices.emplace_back(node);
+			}
+			node = canonicalNodes.at(node);
+		}
+		elementIds.emplace_back(item.id);
+		records.emplace_back(std::move(item.record));
+	}
+}
+
+// Moves the results of a simulation of from onto the ids and node indices of to, the two netlists must be equal
+template<class T>
+static T translate(const T &simulation, const CanonicalNetlist &from, const CanonicalNetlist &to) {
+	T ret = simulation;
+	if (ret.voltages.empty()) return ret;
+
+	std::ranges::fill(ret.voltages, typename decltype(ret.voltages)::value_type{});
+	for (const auto &[fromNode, toNode]: std::views::zip(from.nodeIndices, to.nodeIndices)) {
+		if (fromNode == 0 || toNode == 0) continue;
+		ret.voltages.at(toNode - 1) = simulation.voltages.at(fromNode - 1);
+	}
+
+	std::unordered_map<ElementId, ElementId> ids{};
+	for (const auto &[fromId, toId]: std::views::zip(from.elementIds, to.elementIds)) {
+		ids.emplace(fromId, toId);
+	}
+	for (auto &current: ret.currents) {
+		current.id = ids.at(current.id);
+	}
+	return ret;
+}
+
+template<class T>
+T ResultCache::get(const GraphDescriptor &graph, uint64_t settings, const std::function<T()> &simulate) {
+	CanonicalNetlist netlist{graph};
+	const auto entry = std::ranges::find_if(entries, [&](const Entry &entry) {
+		return std::holds_alternative<T>(entry.simulation) && entry.settings == settings && entry.netlist == netlist;
+	});
+	if (entry != entries.end()) {
+		hits++;
+		entries.splice(entries.begin(), entries, entry);
+		return translate(std::get<T>(entry->simulation), entry->netlist, netlist);
+	}
+
+	misses++;
+	auto simulation = simulate();
+	// Failed runs have nothing to show, there is no point in keeping them
+	if (simulation.voltages.empty() || capacity == 0) return simulation;
+	entries.emplace_front(Entry{
+		.netlist = std::move(netlist),
+		.settings = settings,
+		.simulation = simulation,
+	});
+	if (entries.size() > capacity) entries.pop_back();
+	return simulation;
+}
+
+DCSimulation ResultCache::dc(const GraphDescriptor &graph, const std::function<DCSimulation()> &simulate) {
+	return get(graph, 0, simulate);
+}
+
+ACSimulation ResultCache::ac(const GraphDescriptor &graph, float frequency, const std::function<ACSimulation()> &simulate) {
+	return get(graph, std::bit_cast<uint32_t>(frequency), simulate);
+}
+
+void ResultCache::clear() {
+	entries.clear();
+}
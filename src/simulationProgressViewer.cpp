@@ -0,0 +1,76 @@
+#include "simulationProgressViewer.hpp"
+#include "button.hpp"
+#include "card.hpp"
+#include "column.hpp"
+#include "scrollableFrame.hpp"
+#include "text.hpp"
+#include <format>
+
+using namespace squi;
+
+static std::string_view stageName(SimulationProgress::Stage stage) {
+	switch (stage) {
+		case SimulationProgress::Stage::extraction:
+			return "Extracting the circuit";
+		case SimulationProgress::Stage::assembly:
+			return "Assembling the system";
+		case SimulationProgress::Stage::factorization:
+			return "Factorizing";
+		case SimulationProgress::Stage::solve:
+			return "Solving";
+		case SimulationProgress::Stage::done:
+			return "Done";
+	}
+	return "";
+}
+
+static std::string progressText(const SimulationProgress &progress) {
+	const auto fraction = progress.fraction.load();
+	if (fraction < 0.f) return std::string{stageName(progress.stage)};
+	return std::format("{} ({:.0f}%)", stageName(progress.stage), fraction * 100.f);
+}
+
+SimulationProgressViewer::operator squi::Child() const {
+	return ScrollableFrame{
+		.widget{widget},
+		.scrollableWidget{
+			.padding = 4.f,
+		},
+		.children{
+			Card{
+				.child = Column{
+					.widget{
+						.padding = 8.f,
+					},
+					.spacing = 8.f,
+					.children{
+						Text{
+							.text = "Simulation running",
+							.fontSize = 20.f,
+							.font = FontStore::defaultFontBold,
+						},
+						Text{
+							.widget{
+								.onUpdate = [progress = progress, shownText = progressText(*progress)](Widget &w) mutable {
+									auto text = progressText(*progress);
+									if (text == shownText) return;
+									shownText = std::move(text);
+									w.as<Text::Impl>().setText(shownText);
+								},
+							},
+							.text = progressText(*progress),
+							.color{1.f, 1.f, 1.f, 0.8f},
+						},
+						Button{
+							.text{"Cancel"},
+							.style = ButtonStyle::Standard(),
+							.onClick = [onCancel = onCancel](auto) {
+								if (onCancel) onCancel();
+							},
+						},
+					},
+				},
+			},
+		},
+	};
+}
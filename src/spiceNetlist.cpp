@@ -0,0 +1,402 @@
+#include "spiceNetlist.hpp"
+#include "components/componentStore.hpp"
+#include "netlistBuilder.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <print>
+#include <ranges>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+	// Read only view of a whole file, the pages are only read in as the parser gets to them
+	struct MappedFile {
+		explicit MappedFile(const std::filesystem::path &path) {
+#ifdef _WIN32
+			file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE) return;
+			LARGE_INTEGER size{};
+			if (!GetFileSizeEx(file, &size)) return;
+			opened = true;
+			if (size.QuadPart == 0) return;
+			mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping == nullptr) {
+				opened = false;
+				return;
+			}
+			data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			opened = data != nullptr;
+			length = static_cast<size_t>(size.QuadPart);
+#else
+			descriptor = open(path.c_str(), O_RDONLY);
+			if (descriptor < 0) return;
+			struct stat info{};
+			if (fstat(descriptor, &info) != 0) return;
+			opened = true;
+			if (info.st_size == 0) return;
+			auto *view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, descriptor, 0);
+			if (view == MAP_FAILED) {
+				opened = false;
+				return;
+			}
+			madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+			data = static_cast<const char *>(view);
+			length = static_cast<size_t>(info.st_size);
+#endif
+		}
+		~MappedFile() {
+#ifdef _WIN32
+			if (data != nullptr) UnmapViewOfFile(data);
+			if (mapping != nullptr) CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+			if (data != nullptr) munmap(const_cast<char *>(data), length);
+			if (descriptor >= 0) close(descriptor);
+#endif
+		}
+		MappedFile(const MappedFile &) = delete;
+		MappedFile &operator=(const MappedFile &) = delete;
+
+		[[nodiscard]] std::optional<std::string_view> contents() const {
+			if (!opened) return std::nullopt;
+			return std::string_view{data, length};
+		}
+
+	private:
+#ifdef _WIN32
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = nullptr;
+#else
+		int descriptor = -1;
+#endif
+		const char *data = nullptr;
+		size_t length = 0;
+		bool opened = false;
+	};
+
+	char lower(char c) {
+		return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+
+	bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+		return std::ranges::equal(a, b, {}, lower, lower);
+	}
+
+	// SPICE names are case insensitive
+	struct NameHasher {
+		size_t operator()(std::string_view name) const {
+			size_t ret = 14695981039346656037ull;
+			for (const auto &c: name) ret = (ret ^ static_cast<unsigned char>(lower(c))) * 1099511628211ull;
+			return ret;
+		}
+	};
+	struct NameEqual {
+		bool operator()(std::string_view a, std::string_view b) const {
+			return equalsIgnoreCase(a, b);
+		}
+	};
+	template<class T>
+	using NameMap = std::unordered_map<std::string_view, T, NameHasher, NameEqual>;
+
+	// A number with an optional scale suffix, anything after the suffix is a unit and is ignored (10kOhm, 1uF)
+	std::optional<float> parseValue(std::string_view field) {
+		double value = 0.0;
+		const auto [ptr, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+		if (error != std::errc{}) return std::nullopt;
+		const auto suffix = field.substr(static_cast<size_t>(ptr - field.data()));
+		if (suffix.empty()) return static_cast<float>(value);
+		if (!std::isalpha(static_cast<unsigned char>(suffix.front()))) return std::nullopt;
+
+		const auto startsWith = [&](std::string_view prefix) {
+			return suffix.size() >= prefix.size() && equalsIgnoreCase(suffix.substr(0, prefix.size()), prefix);
+		};
+		// Checked before m, which is milli
+		if (startsWith("meg")) return static_cast<float>(value * 1e6);
+		if (startsWith("mil")) return static_cast<float>(value * 25.4e-6);
+		switch (lower(suffix.front())) {
+			case 't':
+				return static_cast<float>(value * 1e12);
+			case 'g':
+				return static_cast<float>(value * 1e9);
+			case 'k':
+				return static_cast<float>(value * 1e3);
+			case 'm':
+				return static_cast<float>(value * 1e-3);
+			case 'u':
+				return static_cast<float>(value * 1e-6);
+			case 'n':
+				return static_cast<float>(value * 1e-9);
+			case 'p':
+				return static_cast<float>(value * 1e-12);
+			case 'f':
+				return static_cast<float>(value * 1e-15);
+			default:
+				return static_cast<float>(value);
+		}
+	}
+
+	// One element card, the fields point into the deck
+	struct Record {
+		uint32_t componentId;
+		uint32_t propertySetIndex = 0;
+		std::array<uint32_t, 2> nodes{};
+		std::array<float, 2> values{};
+		// Only the first valueCount values are used
+		uint32_t valueCount = 2;
+		// Only set for diodes, resolved once the whole deck is read since a model can come after its first use
+		std::string_view model{};
+		size_t line;
+	};
+
+	struct DiodeModel {
+		float saturationCurrent = 1e-14f;
+		float emissionCoefficient = 1.f;
+	};
+
+	// Components by the first letter of their cards
+	const Component *componentFor(char letter) {
+		for (const auto &component: ComponentStore::components) {
+			const auto &comp = component.get();
+			if (comp.type == ElementType::Other && comp.prefix.size() == 1 && lower(comp.prefix.front()) == lower(letter)) return &comp;
+		}
+		return nullptr;
+	}
+
+	// The voltage source keeps its positive terminal on the second pin, SPICE lists it first
+	bool reversedPins(const Component &component) {
+		return component.prefix == "V";
+	}
+
+	bool isSourceFunction(std::string_view field) {
+		for (const auto &name: {"sin", "pulse", "exp", "pwl", "sffm"}) {
+			if (equalsIgnoreCase(field, name)) return true;
+		}
+		return false;
+	}
+}// namespace
+
+std::optional<GraphDescriptor> SpiceNetlist::parse(std::string_view deck) {
+	NetlistBuilder builder{};
+	NameMap<uint32_t> nodeIds{};
+	const auto nodeOf = [&](std::string_view name) {
+		if (name == "0" || equalsIgnoreCase(name, "gnd")) return NetlistBuilder::ground;
+		const auto [it, inserted] = nodeIds.try_emplace(name, 0);
+		if (inserted) it->second = builder.addNode();
+		return it->second;
+	};
+
+	std::vector<Record> records{};
+	NameMap<DiodeModel> models{};
+	bool failed = false;
+	const auto fail = [&](size_t line, std::string_view message) {
+		std::println(stderr, "SPICE line {}: {}", line, message);
+		failed = true;
+	};
+
+	// The fields of the current card, continuation lines starting with + are appended to it
+	std::vector<std::string_view> fields{};
+	size_t cardLine = 0;
+	const auto finishCard = [&]() {
+		if (fields.empty()) return;
+		const auto &name = fields.front();
+		const auto number = [&](size_t index) -> std::optional<float> {
+			if (index >= fields.size()) return std::nullopt;
+			return parseValue(fields.at(index));
+		};
+
+		if (name.front() == '.') {
+			if (equalsIgnoreCase(name, ".model")) {
+				if (fields.size() < 3 || !equalsIgnoreCase(fields.at(2), "d")) return;
+				DiodeModel model{};
+				for (size_t i = 3; i + 1 < fields.size(); i += 2) {
+					const auto value = parseValue(fields.at(i + 1));
+					if (!value) return fail(cardLine, "invalid model parameter");
+					if (equalsIgnoreCase(fields.at(i), "is")) model.saturationCurrent = *value;
+					if (equalsIgnoreCase(fields.at(i), "n")) model.emissionCoefficient = *value;
+				}
+				models.insert_or_assign(fields.at(1), model);
+			} else if (equalsIgnoreCase(name, ".subckt") || equalsIgnoreCase(name, ".include") || equalsIgnoreCase(name, ".lib")) {
+				fail(cardLine, "subcircuits and includes are not supported");
+			}
+			// Analysis and output cards don't change the netlist
+			return;
+		}
+
+		const auto *component = componentFor(name.front());
+		if (component == nullptr || fields.size() < 3) return fail(cardLine, "unsupported card");
+		auto &record = records.emplace_back(Record{.componentId = component->id, .line = cardLine});
+		record.nodes = {nodeOf(fields.at(1)), nodeOf(fields.at(2))};
+		if (reversedPins(*component)) std::swap(record.nodes.at(0), record.nodes.at(1));
+
+		switch (lower(name.front())) {
+			case 'v':
+			case 'i': {
+				// A source with an A.C. part is taken in A.C. mode, an element only has one mode
+				std::optional<float> dc{};
+				std::optional<float> acMagnitude{};
+				float acPhase = 0.f;
+				for (size_t i = 3; i < fields.size(); i++) {
+					if (equalsIgnoreCase(fields.at(i), "dc")) {
+						dc = number(++i);
+						if (!dc) return fail(cardLine, "invalid D.C. value");
+					} else if (equalsIgnoreCase(fields.at(i), "ac")) {
+						acMagnitude = number(++i);
+						if (!acMagnitude) return fail(cardLine, "invalid A.C. magnitude");
+						if (const auto phase = number(i + 1); phase) {
+							acPhase = *phase;
+							i++;
+						}
+					} else if (isSourceFunction(fields.at(i))) {
+						// Time domain functions only matter to a SPICE transient analysis
+						break;
+					} else if (const auto value = number(i); value && !dc) {
+						dc = value;
+					} else {
+						return fail(cardLine, "invalid source value");
+					}
+				}
+				if (acMagnitude) {
+					record.propertySetIndex = 1;
+					record.values = {*acMagnitude, acPhase};
+				} else {
+					record.values = {dc.value_or(0.f)};
+					record.valueCount = 1;
+				}
+				break;
+			}
+			case 'd':
+				if (fields.size() < 4) return fail(cardLine, "missing diode model");
+				record.model = fields.at(3);
+				break;
+			default: {
+				const auto value = number(3);
+				if (!value) return fail(cardLine, "invalid value");
+				record.values = {*value};
+				record.valueCount = 1;
+				break;
+			}
+		}
+	};
+
+	size_t lineNumber = 0;
+	while (!deck.empty()) {
+		const auto end = deck.find('\n');
+		auto line = deck.substr(0, end);
+		deck.remove_prefix(end == std::string_view::npos ? deck.size() : end + 1);
+		lineNumber++;
+
+		// The first line is always the title
+		if (lineNumber == 1) continue;
+		line = line.substr(0, line.find_first_of(";$"));
+		if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+		if (line.empty() || line.front() == '*') continue;
+
+		const bool continuation = line.front() == '+';
+		if (continuation) {
+			line.remove_prefix(1);
+		} else {
+			finishCard();
+			fields.clear();
+			cardLine = lineNumber;
+		}
+
+		static constexpr std::string_view separators{" \t\r,()="};
+		while (true) {
+			const auto start = line.find_first_not_of(separators);
+			if (start == std::string_view::npos) break;
+			line.remove_prefix(start);
+			const auto fieldEnd = std::min(line.find_first_of(separators), line.size());
+			fields.emplace_back(line.substr(0, fieldEnd));
+			line.remove_prefix(fieldEnd);
+		}
+		if (!continuation && !fields.empty() && equalsIgnoreCase(fields.front(), ".end")) {
+			fields.clear();
+			break;
+		}
+	}
+	finishCard();
+	if (failed) return std::nullopt;
+
+	// Every element is added, so the ids follow the cards even when some of them are left out
+	for (const auto &record: records) {
+		auto values = record.values;
+		if (!record.model.empty()) {
+			const auto model = models.find(record.model);
+			if (model == models.end()) {
+				std::println(stderr, "SPICE line {}: unknown diode model {}", record.line, record.model);
+				return std::nullopt;
+			}
+			values = {model->second.saturationCurrent, model->second.emissionCoefficient};
+		}
+		if (!builder.addElement(static_cast<NetlistBuilder::Type>(record.componentId), record.nodes, std::span(values).first(record.valueCount), record.propertySetIndex)) return std::nullopt;
+	}
+	auto graph = builder.build();
+	// Nodes are only left out when all their elements are shorted, the remaining nodes shift down to fill the gap
+	if (GraphDescriptor::verbose) {
+		for (const auto &[name, node]: nodeIds) {
+			if (!builder.nodeIndex(node).has_value()) std::println("Note: SPICE node {} left out, every element on it has all its pins on the same node", name);
+		}
+	}
+	return graph;
+}
+
+std::optional<GraphDescriptor> SpiceNetlist::read(const std::filesystem::path &path) {
+	const MappedFile file{path};
+	const auto contents = file.contents();
+	if (!contents) {
+		std::println(stderr, "Failed to open {}", path.string());
+		return std::nullopt;
+	}
+	return parse(*contents);
+}
+
+void SpiceNetlist::write(std::FILE *out, const GraphDescriptor &graph) {
+	std::println(out, "CircuitSimulator netlist");
+	std::vector<size_t> diodes{};
+	for (const auto &[index, element]: graph.elements | std::views::enumerate) {
+		const auto &component = element.component.get();
+		const auto nodes = graph.nodesOf(static_cast<size_t>(index));
+		const auto first = reversedPins(component) ? nodes[1] : nodes[0];
+		const auto second = reversedPins(component) ? nodes[0] : nodes[1];
+		std::print(out, "{}{} {} {}", component.prefix, element.id, first, second);
+
+		const auto values = graph.valuesOf(static_cast<size_t>(index));
+		if (component.prefix == "V" || component.prefix == "I") {
+			if (element.propertySetIndex == 1) {
+				std::println(out, " AC {} {}", values[0].value, values[1].value);
+			} else {
+				std::println(out, " DC {}", values[0].value);
+			}
+		} else if (component.prefix == "D") {
+			// Every diode gets a model of its own, named after it
+			std::println(out, " D{}", element.id);
+			diodes.emplace_back(static_cast<size_t>(index));
+		} else {
+			std::println(out, " {}", values[0].value);
+		}
+	}
+	for (const auto &index: diodes) {
+		const auto values = graph.valuesOf(index);
+		std::println(out, ".model D{} D(IS={} N={})", graph.elements.at(index).id, values[0].value, values[1].value);
+	}
+	std::println(out, ".end");
+}
+
+bool SpiceNetlist::write(const std::filesystem::path &path, const GraphDescriptor &graph) {
+	std::FILE *out = std::fopen(path.string().c_str(), "w");
+	if (!out) return false;
+	write(out, graph);
+	return std::fclose(out) == 0;
+}
@@ -0,0 +1,151 @@
+#include "threadPool.hpp"
+#include <utility>
+
+// The pool and the index of the worker running on this thread, for running nested parallelFor calls inline
+static thread_local const ThreadPool *currentPool = nullptr;
+static thread_local size_t currentWorker = 0;
+
+ThreadPool::ThreadPool(size_t threadCount) : ranges(std::make_unique<WorkRange[]>(threadCount)) {
+	threads.reserve(threadCount);
+	for (size_t i = 0; i < threadCount; i++) {
+		threads.emplace_back([this, i]() {
+			workerLoop(i);
+		});
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::scoped_lock lock{mutex};
+		stopping = true;
+	}
+	jobAvailable.notify_all();
+	for (auto &thread: threads) {
+		thread.join();
+	}
+}
+
+ThreadPool &ThreadPool::shared() {
+	static ThreadPool pool{};
+	return pool;
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t)> &func) {
+	if (count == 0) return;
+	// Waiting for the other workers from inside one of them would never end
+	if (currentPool == this) {
+		for (size_t index = 0; index < count; index++) {
+			func(currentWorker, index);
+		}
+		return;
+	}
+	std::scoped_lock submitLock{submitMutex};
+
+	// Contiguous slices keep neighbouring indices (and their cache lines) on the same thread
+	const auto workerCount = threads.size();
+	for (size_t i = 0; i < workerCount; i++) {
+		std::scoped_lock rangeLock{ranges[i].mutex};
+		ranges[i].begin = count * i / workerCount;
+		ranges[i].end = count * (i + 1) / workerCount;
+	}
+
+	std::unique_lock lock{mutex};
+	job.func = &func;
+	job.count = count;
+	// Small chunks keep the threads balanced when some indices take longer than others
+	job.chunkSize = std::max<size_t>(1, count / (workerCount * 8));
+	job.activeWorkers = workerCount;
+	job.exception = nullptr;
+	aborted = false;
+	generation++;
+	lock.unlock();
+	jobAvailable.notify_all();
+
+	lock.lock();
+	jobFinished.wait(lock, [&]() {
+		return job.activeWorkers == 0;
+	});
+	job.func = nullptr;
+	if (job.exception) std::rethrow_exception(std::exchange(job.exception, nullptr));
+}
+
+std::pair<size_t, size_t> ThreadPool::takeOwn(size_t workerIndex) {
+	auto &range = ranges[workerIndex];
+	std::scoped_lock lock{range.mutex};
+	const auto begin = range.begin;
+	const auto end = std::min(range.end, begin + job.chunkSize);
+	range.begin = end;
+	return {begin, end};
+}
+
+bool ThreadPool::steal(size_t workerIndex) {
+	const auto workerCount = threads.size();
+	while (true) {
+		// Pick the victim with the most work left, the sizes are only a hint since they can change once the lock is released
+		size_t victim = workerIndex;
+		size_t mostLeft = 0;
+		for (size_t offset = 1; offset < workerCount; offset++) {
+			const auto index = (workerIndex + offset) % workerCount;
+			auto &range = ranges[index];
+			std::scoped_lock lock{range.mutex};
+			const auto left = range.end - range.begin;
+			if (left > mostLeft) {
+				mostLeft = left;
+				victim = index;
+			}
+		}
+		if (victim == workerIndex) return false;
+
+		std::scoped_lock lock{ranges[victim].mutex, ranges[workerIndex].mutex};
+		auto &from = ranges[victim];
+		const auto left = from.end - from.begin;
+		// Someone else got there first, look for another victim
+		if (left == 0) continue;
+		auto &to = ranges[workerIndex];
+		const auto middle = from.end - (left + 1) / 2;
+		to.begin = middle;
+		to.end = from.end;
+		from.end = middle;
+		steals.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+}
+
+void ThreadPool::workerLoop(size_t workerIndex) {
+	currentPool = this;
+	currentWorker = workerIndex;
+	uint64_t lastGeneration = 0;
+	while (true) {
+		std::unique_lock lock{mutex};
+		jobAvailable.wait(lock, [&]() {
+			return stopping || generation != lastGeneration;
+		});
+		if (stopping) return;
+		lastGeneration = generation;
+		const auto &func = *job.func;
+		lock.unlock();
+
+		while (!aborted) {
+			const auto [begin, end] = takeOwn(workerIndex);
+			if (begin == end) {
+				if (steal(workerIndex)) continue;
+				break;
+			}
+			try {
+				for (size_t index = begin; index < end && !aborted; index++) {
+					func(workerIndex, index);
+				}
+			} catch (...) {
+				std::scoped_lock exceptionLock{mutex};
+				if (!job.exception) job.exception = std::current_exception();
+				aborted = true;
+			}
+		}
+
+		lock.lock();
+		if (--job.activeWorkers == 0) {
+			lock.unlock();
+			jobFinished.notify_all();
+		}
+	}
+}
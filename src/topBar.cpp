@@ -1,9 +1,13 @@
 #include "topBar.hpp"
+
+#include "../extern/portable-file-dialogs/portable-file-dialogs.h"
+
 #include "align.hpp"
 #include "box.hpp"
 #include "button.hpp"
 #include "column.hpp"
 #include "components/componentStore.hpp"
+#include "componentTextures.hpp"
 #include "contextMenu.hpp"
 #include "fontIcon.hpp"
 #include "gestureDetector.hpp"
@@ -17,6 +21,31 @@
 
 using namespace squi;
 
+static const std::vector<std::string> saveFileFilters{
+	"Circuit Simulator Save File (*.sqcs)",
+	"*.sqcs",
+	"All Files (*.*)",
+	"*",
+};
+
+static void saveBoard(const BoardStorage &boardStorage) {
+	auto pathStr = pfd::save_file("Save", {}, saveFileFilters).result();
+
+	if (!pathStr.empty()) {
+		std::println("Saving to: {}", pathStr);
+		boardStorage.saveToFile(pathStr);
+	}
+}
+
+static void loadBoard(BoardStorage &boardStorage) {
+	auto pathStr = pfd::open_file("Load", {}, saveFileFilters).result();
+
+	if (!pathStr.empty()) {
+		std::println("Loading save: {}", pathStr.front());
+		boardStorage.loadFromFile(pathStr.front());
+	}
+}
+
 struct TopBarButton {
 	// Args
 	squi::Widget::Args widget{};
@@ -116,6 +145,24 @@ TopBar::operator squi::Child() const {
 											onRun.notify(SimulationType::acSim);
 										},
 									},
+									ContextMenu::Item{
+										.text = "A.C. Sweep",
+										.content = [onRun]() {
+											onRun.notify(SimulationType::acSweep);
+										},
+									},
+									ContextMenu::Item{
+										.text = "Transient Simulation",
+										.content = [onRun]() {
+											onRun.notify(SimulationType::transientSim);
+										},
+									},
+									ContextMenu::Item{
+										.text = "Monte Carlo",
+										.content = [onRun]() {
+											onRun.notify(SimulationType::monteCarlo);
+										},
+									},
 								},
 							});
 						},
@@ -126,7 +173,7 @@ TopBar::operator squi::Child() const {
 					},
 					TopBarButton{
 						.onClick = [storage](GestureDetector::Event) {
-							storage->boardStorage.load();
+							loadBoard(storage->boardStorage);
 						},
 						.child = IconTextCombo{
 							.icon = 0xED43,
@@ -135,7 +182,7 @@ TopBar::operator squi::Child() const {
 					},
 					TopBarButton{
 						.onClick = [storage](GestureDetector::Event) {
-							storage->boardStorage.save();
+							saveBoard(storage->boardStorage);
 						},
 						.child = IconTextCombo{
 							.icon = 0xEA35,
@@ -163,7 +210,7 @@ TopBar::operator squi::Child() const {
 									.width{40.f},
 									.height{40.f},
 								},
-								.texture = comp.get().textureThumb,
+								.texture = ComponentTextures::of(comp.get()).thumb,
 								.color{0xFFFFFFFF},
 							},
 						},
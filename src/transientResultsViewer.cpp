@@ -0,0 +1,129 @@
+#include "transientResultsViewer.hpp"
+#include "card.hpp"
+#include "graphView.hpp"
+#include "resultsCard.hpp"
+#include "resultsItem.hpp"
+#include "scrollableFrame.hpp"
+
+
+using namespace squi;
+
+static inline std::vector<std::string_view> columnNames{
+	"Index",
+	"Final value",
+};
+
+std::vector<Graph::LineValue> generateTimeData(const std::vector<float> &times, const std::vector<float> &values) {
+	std::vector<Graph::LineValue> data{};
+	data.reserve(times.size());
+	for (const auto &[time, value]: std::views::zip(times, values)) {
+		data.emplace_back(Graph::LineValue{
+			.value = value,
+			.x = time,
+		});
+	}
+
+	return data;
+}
+
+TransientResultsViewer::operator squi::Child() const {
+	auto storage = std::make_shared<Storage>();
+	// The traces are only turned into graph data when clicked, the lambdas share this single copy of the results
+	auto transient = std::make_shared<const TransientSimulation>(simulation);
+
+	return ScrollableFrame{
+		.widget{widget},
+		.scrollableWidget{
+			.padding = 4.f,
+		},
+		.spacing = 4.f,
+		.children = [&]() -> Children {
+			Observable<const std::vector<Graph::LineValue> &> graphDataUpdater{};
+			Children ret{
+				Card{
+					.child = GraphView{
+						.widget{
+							.height = 300.f,
+							.margin = 4.f,
+						},
+						.updateData = graphDataUpdater,
+						.values{},
+					},
+				},
+			};
+
+			ret.emplace_back(ResultsCard{
+				.title = "Steps",
+				.columns{"Accepted", "Rejected", "Factorizations"},
+				.children{
+					ResultsItem{
+						.items{
+							std::format("{}", simulation.acceptedStepCount),
+							std::format("{}", simulation.rejectedStepCount),
+							std::format("{}", simulation.factorizationCount),
+						},
+					},
+				},
+			});
+
+			if (!graph.elementsOf(8).empty()) {
+				ret.emplace_back(ResultsCard{
+					.title = "Not simulated",
+					.columns{"Reason"},
+					.children{
+						ResultsItem{
+							.items{"Diodes aren't supported by this analysis yet"},
+						},
+					},
+				});
+			}
+
+			if (!simulation.voltages.empty()) {
+				Children voltRet{};
+				for (const auto &[index, trace]: simulation.voltages | std::views::enumerate) {
+					const auto nodeLines = graph.linesAt(static_cast<uint32_t>(index + 1));
+					voltRet.emplace_back(ResultsItem{
+						.items{
+							std::format("Node #{}", index + 1),
+							trace.empty() ? std::string{} : std::format("{:.2f}V", trace.back()),
+						},
+						.onClick = [elementSelector = elementSelector, lines = std::vector<ElementId>{nodeLines.begin(), nodeLines.end()}, graphDataUpdater, transient, index]() {
+							elementSelector.notify(lines);
+
+							graphDataUpdater.notify(generateTimeData(transient->times, transient->voltages.at(index)));
+						},
+					});
+				}
+				ret.emplace_back(ResultsCard{
+					.title = "Voltages",
+					.columns = columnNames,
+					.children = voltRet,
+				});
+			}
+
+			if (!simulation.currents.empty()) {
+				Children currRet{};
+				for (const auto &[index, current]: simulation.currents | std::views::enumerate) {
+					currRet.emplace_back(ResultsItem{
+						.items{
+							std::format("{} #{}", board.getElement(current.id)->get().element.component.get().name, current.id),
+							current.values.empty() ? std::string{} : std::format("{:.2f}A", current.values.back()),
+						},
+						.onClick = [elementSelector = elementSelector, id = current.id, graphDataUpdater, transient, index]() {
+							elementSelector.notify({id});
+
+							graphDataUpdater.notify(generateTimeData(transient->times, transient->currents.at(index).values));
+						},
+					});
+				}
+				ret.emplace_back(ResultsCard{
+					.title = "Currents",
+					.columns = columnNames,
+					.children = currRet,
+				});
+			}
+
+			return ret;
+		}(),
+	};
+}
@@ -0,0 +1,245 @@
+#include "transientSimulation.hpp"
+#include "numbers"
+#include <algorithm>
+#include <array>
+
+// Estimated local truncation error of the newest point, from the divided difference over order + 2 points
+// Backward Euler: h^2 / 2 * d2x/dt2, trapezoidal: h^3 / 12 * d3x/dt3
+static double truncationError(size_t order, double newTime, double newState, const std::array<double, 3> &pastTimes, const std::array<double, 3> &pastStates, double step) {
+	std::array<double, 4> times{newTime};
+	std::array<double, 4> differences{newState};
+	for (size_t i = 0; i <= order; i++) {
+		times.at(i + 1) = pastTimes.at(i);
+		differences.at(i + 1) = pastStates.at(i);
+	}
+	for (size_t level = 1; level <= order + 1; level++) {
+		for (size_t i = 0; i + level <= order + 1; i++) {
+			differences.at(i) = (differences.at(i) - differences.at(i + 1)) / (times.at(i) - times.at(i + level));
+		}
+	}
+	// The n-th derivative is n! times the n-th divided difference
+	const auto constant = order == 1 ? 1.0 : 0.5;
+	return constant * std::pow(step, static_cast<double>(order + 1)) * std::abs(differences.front());
+}
+
+
+TransientSimulation::TransientSimulation(const GraphDescriptor &graph, const Settings &settings) {
+	std::optional<MnaSystem<double>> system{};
+	*this = TransientSimulation(graph, settings, system);
+}
+
+TransientSimulation::TransientSimulation(const GraphDescriptor &graph, const Settings &settings, std::optional<MnaSystem<double>> &system, SimulationProgress *progress)
+	: settings(settings) {
+	if (graph.nodeCount < 2 || settings.timeStep <= 0.f || settings.stopTime <= 0.f) return;
+	// Leaving the diodes open would give the results of a different circuit
+	if (!graph.elementsOf(8).empty()) {
+		std::println("The transient simulation doesn't support diodes yet, circuits with diodes can only be solved in D.C.");
+		return;
+	}
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::assembly)) return;
+	MnaTopology newTopology{graph};
+	if (!system.has_value() || system->topology().hash() != newTopology.hash() || system->topology() != newTopology) {
+		system.emplace(std::move(newTopology));
+	}
+	const auto &topology = system->topology();
+
+	// Capacitor or inductor, i = conductance * v - history
+	struct ReactiveBranch {
+		size_t index;
+		bool capacitor;
+		// Capacitance or inductance
+		double value;
+		double conductance = 0.0;
+		double voltage = 0.0;
+		double current = 0.0;
+	};
+	struct SourceBranch {
+		size_t index;
+		bool ac;
+		double amplitude;
+		double phase;
+	};
+
+	std::vector<double> values(topology.branches.size());
+	std::vector<ReactiveBranch> reactive{};
+	std::vector<SourceBranch> sources{};
+	for (const auto &[index, element]: graph.elements | std::views::enumerate) {
+		const auto id = element.component.get().id;
+		if (id == 2 || id == 3) {
+			// Voltage or current source
+			const bool ac = element.propertySetIndex == 1;
+			sources.emplace_back(SourceBranch{
+				.index = static_cast<size_t>(index),
+				.ac = ac,
+				.amplitude = ac ? std::numbers::sqrt2 * graph.value(index, 0) : graph.value(index, 0),
+				.phase = ac ? graph.value(index, 1) * std::numbers::pi / 180.0 : 0.0,
+			});
+		} else if (id == 4) {
+			// Resistor
+			values.at(index) = 1.0 / graph.value(index, 0);
+		} else if (id == 6 || id == 7) {
+			// Capacitor or inductor
+			reactive.emplace_back(ReactiveBranch{
+				.index = static_cast<size_t>(index),
+				.capacitor = id == 6,
+				.value = graph.value(index, 0),
+			});
+		}
+	}
+
+	auto method = settings.method;
+	double factoredStep = 0.0;
+	const auto factorize = [&](double step) {
+		const auto scale = method == Method::trapezoidal ? 2.0 : 1.0;
+		for (auto &branch: reactive) {
+			branch.conductance = branch.capacitor ? scale * branch.value / step : step / (scale * branch.value);
+			values.at(branch.index) = branch.conductance;
+		}
+		factoredStep = step;
+		factorizationCount++;
+		return system->refactor(values);
+	};
+	// Trapezoidal needs the element currents at the start of the step, these aren't known at t = 0
+	// so the first step is taken with backward Euler and the system is factorized a second time after it
+	if (!reactive.empty()) method = Method::backwardEuler;
+
+	const bool adaptive = settings.adaptive && !reactive.empty();
+	const auto stopTime = static_cast<double>(settings.stopTime);
+	const auto timeStep = static_cast<double>(settings.timeStep);
+	const auto minStep = std::max(static_cast<double>(settings.minTimeStep), static_cast<double>(std::numeric_limits<float>::min()));
+	const auto maxStep = std::max(static_cast<double>(settings.maxTimeStep), minStep);
+	auto h = adaptive ? std::clamp(timeStep, minStep, maxStep) : timeStep;
+	// Settings are floats, so 1e-3 / 1e-5 comes out slightly above 100; the slack keeps that from adding a step past the stop time
+	const auto totalSteps = static_cast<uint64_t>(std::ceil(stopTime / timeStep * (1.0 - 1e-6)));
+	const auto finished = [&](double time) {
+		return adaptive ? stopTime - time < 0.5 * minStep : acceptedStepCount >= totalSteps;
+	};
+
+	const auto nodeCount = static_cast<int64_t>(topology.nodeCount) - 1;
+	const auto stride = std::max<uint32_t>(1, settings.outputStride);
+	// The number of adaptive steps isn't known up front
+	const auto storedCount = adaptive ? 0 : totalSteps / stride + 1;
+	times.reserve(storedCount);
+	voltages.resize(nodeCount);
+	for (auto &trace: voltages) trace.reserve(storedCount);
+	for (const auto &branch: topology.branches) {
+		if (branch.type != MnaBranch::Type::voltageSource) continue;
+		currents.emplace_back(CurrentTrace{.id = branch.id}).values.reserve(storedCount);
+	}
+
+	const auto omega = 2.0 * std::numbers::pi * settings.sourceFrequency;
+	const auto nodeVoltage = [&](const MnaSystem<double>::Vector &solution, uint32_t node) {
+		return node == 0 ? 0.0 : solution(node - 1);
+	};
+	// Current that the companion model injects back into the circuit, from the state of the previous step
+	const auto historyCurrent = [&](const ReactiveBranch &branch) {
+		const bool trapezoidal = method == Method::trapezoidal;
+		if (branch.capacitor) {
+			return trapezoidal ? branch.conductance * branch.voltage + branch.current : branch.conductance * branch.voltage;
+		}
+		return trapezoidal ? -(branch.current + branch.conductance * branch.voltage) : -branch.current;
+	};
+
+	// The last accepted points of every state variable (capacitor voltage or inductor current), newest first
+	// Backward Euler needs 2 of them for its error estimate and trapezoidal 3
+	std::array<double, 3> pastTimes{};
+	std::vector<std::array<double, 3>> pastStates(reactive.size());
+	size_t pastCount = 1;
+	std::vector<std::pair<double, double>> candidates(reactive.size());
+
+	if (!SimulationProgress::report(progress, SimulationProgress::Stage::solve)) return;
+	double time = 0.0;
+	while (!finished(time)) {
+		if (!SimulationProgress::advance(progress, static_cast<float>(time / stopTime))) {
+			times.clear();
+			voltages.clear();
+			currents.clear();
+			return;
+		}
+		auto step = h;
+		// Land exactly on the stop time instead of leaving a sliver of a step at the end
+		if (adaptive && stopTime - time - step < minStep) step = stopTime - time;
+		if (step != factoredStep && !factorize(step)) break;
+
+		const auto newTime = adaptive ? time + step : static_cast<double>(acceptedStepCount + 1) * step;
+		for (const auto &source: sources) {
+			values.at(source.index) = source.ac ? source.amplitude * std::sin(omega * newTime + source.phase) : source.amplitude;
+		}
+
+		auto rhs = system->sourceVector(values);
+		for (const auto &branch: reactive) {
+			const auto &mnaBranch = topology.branches.at(branch.index);
+			const auto current = historyCurrent(branch);
+			if (mnaBranch.nodeA != 0) rhs(mnaBranch.nodeA - 1) += current;
+			if (mnaBranch.nodeB != 0) rhs(mnaBranch.nodeB - 1) -= current;
+		}
+
+		const auto solution = system->solve(rhs);
+		if (!solution.has_value()) {
+			std::println("Transient simulation stopped at t = {}s", newTime);
+			break;
+		}
+
+		for (auto &&[branch, candidate]: std::views::zip(reactive, candidates)) {
+			const auto &mnaBranch = topology.branches.at(branch.index);
+			const auto voltage = nodeVoltage(*solution, mnaBranch.nodeA) - nodeVoltage(*solution, mnaBranch.nodeB);
+			candidate = {voltage, branch.conductance * voltage - historyCurrent(branch)};
+		}
+
+		if (adaptive) {
+			const auto order = method == Method::trapezoidal ? 2uz : 1uz;
+			double growth = 2.0;
+			// Not enough history for an estimate yet, these steps are accepted as they are
+			if (pastCount > order) {
+				// Ratio between the estimated local truncation error and the allowed error, worst state wins
+				double worstRatio = 0.0;
+				for (const auto &[branch, candidate, past]: std::views::zip(reactive, candidates, pastStates)) {
+					const auto state = branch.capacitor ? candidate.first : candidate.second;
+					const auto error = truncationError(order, newTime, state, pastTimes, past, step);
+					const auto tolerance = settings.relTol * std::max(std::abs(state), std::abs(past.front())) + settings.absTol;
+					worstRatio = std::max(worstRatio, error / tolerance);
+				}
+				growth = worstRatio == 0.0 ? 2.0 : 0.9 * std::pow(worstRatio, -1.0 / static_cast<double>(order + 1));
+
+				if (worstRatio > 1.0) {
+					rejectedStepCount++;
+					if (step <= minStep) {
+						std::println("Transient simulation stopped at t = {}s, the time step got too small", time);
+						break;
+					}
+					h = std::max(step * std::clamp(growth, 0.1, 0.5), minStep);
+					continue;
+				}
+			}
+			// Small changes aren't worth a new factorization, only grow once it pays off
+			if (growth >= 1.25 && pastCount > order) h = std::min(step * std::min(growth, 2.0), maxStep);
+		}
+
+		time = newTime;
+		acceptedStepCount++;
+		for (auto &&[branch, candidate, past]: std::views::zip(reactive, candidates, pastStates)) {
+			branch.voltage = candidate.first;
+			branch.current = candidate.second;
+			std::shift_right(past.begin(), past.end(), 1);
+			past.front() = branch.capacitor ? branch.voltage : branch.current;
+		}
+		std::shift_right(pastTimes.begin(), pastTimes.end(), 1);
+		pastTimes.front() = time;
+		pastCount = std::min(pastCount + 1, pastTimes.size());
+
+		if (method != settings.method) {
+			method = settings.method;
+			// Refactor with the new method before the next step
+			factoredStep = 0.0;
+		}
+
+		if (acceptedStepCount % stride != 0 && !finished(time)) continue;
+		times.emplace_back(static_cast<float>(time));
+		for (int64_t i = 0; i < nodeCount; i++) {
+			voltages.at(i).emplace_back(static_cast<float>((*solution)(i)));
+		}
+		for (auto &&[i, current]: currents | std::views::enumerate) {
+			current.values.emplace_back(static_cast<float>((*solution)(nodeCount + i)));
+		}
+	}
+}
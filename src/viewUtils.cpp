@@ -0,0 +1,61 @@
+#include "viewUtils.hpp"
+#include "config.hpp"
+#include "utils.hpp"
+
+Coords Utils::screenToGridRounded(const squi::vec2 &screen, const squi::vec2 &offset, const squi::vec2 &boardPos) {
+	const auto virtualPos = screen - boardPos - offset;
+
+	auto gridPos = virtualPos / gridSize;
+	return Coords{
+		.x = static_cast<int32_t>(std::round(gridPos.x)),
+		.y = static_cast<int32_t>(std::round(gridPos.y)),
+	};
+}
+
+Coords Utils::screenToGridFloored(const squi::vec2 &screen, const squi::vec2 &offset, const squi::vec2 &boardPos) {
+	const auto virtualPos = screen - boardPos - offset;
+
+	auto gridPos = virtualPos / gridSize;
+	return Coords{
+		.x = static_cast<int32_t>(std::floor(gridPos.x)),
+		.y = static_cast<int32_t>(std::floor(gridPos.y)),
+	};
+}
+
+Utils::RotatedElementData Utils::rotateElement(uint32_t rotation, const Component &comp) {
+	RotatedElementData ret{
+		.newNodes = rotateNodes(rotation, comp),
+	};
+	switch (rotation % 4) {
+		case 0: {
+			ret.newTopLeft = {comp.uvTopLeft.x, comp.uvTopLeft.y};
+			ret.newTopRight = {comp.uvBottomRight.x, comp.uvTopLeft.y};
+			ret.newBottomRight = {comp.uvBottomRight.x, comp.uvBottomRight.y};
+			ret.newBottomLeft = {comp.uvTopLeft.x, comp.uvBottomRight.y};
+			break;
+		}
+		case 1: {
+			ret.newTopLeft = {comp.uvTopLeft.x, comp.uvBottomRight.y};
+			ret.newTopRight = {comp.uvTopLeft.x, comp.uvTopLeft.y};
+			ret.newBottomRight = {comp.uvBottomRight.x, comp.uvTopLeft.y};
+			ret.newBottomLeft = {comp.uvBottomRight.x, comp.uvBottomRight.y};
+			break;
+		}
+		case 2: {
+			ret.newTopLeft = {comp.uvBottomRight.x, comp.uvBottomRight.y};
+			ret.newTopRight = {comp.uvTopLeft.x, comp.uvBottomRight.y};
+			ret.newBottomRight = {comp.uvTopLeft.x, comp.uvTopLeft.y};
+			ret.newBottomLeft = {comp.uvBottomRight.x, comp.uvTopLeft.y};
+			break;
+		}
+		case 3: {
+			ret.newTopLeft = {comp.uvBottomRight.x, comp.uvTopLeft.y};
+			ret.newTopRight = {comp.uvBottomRight.x, comp.uvBottomRight.y};
+			ret.newBottomRight = {comp.uvTopLeft.x, comp.uvBottomRight.y};
+			ret.newBottomLeft = {comp.uvTopLeft.x, comp.uvTopLeft.y};
+			break;
+		}
+	}
+
+	return ret;
+}